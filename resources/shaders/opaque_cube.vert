@@ -3,6 +3,7 @@
 layout (location = 0) in uint in_data;
 
 uniform mat4 MVP;
+uniform uint log_chunk_size;
 
 out vec2 uv;
 out float ao;
@@ -12,6 +13,16 @@ flat out uint normal;
 
 float aos[4] = { 0, 1.0f/3, 2.0f/3, 1 };
 
+// cube corners per face, same order as BlockRenderer::CubeVertices
+vec3 corners[24] = {
+	vec3(1, 0, 1), vec3(1, 1, 1), vec3(1, 1, 0), vec3(1, 0, 0),
+	vec3(1, 1, 1), vec3(0, 1, 1), vec3(0, 1, 0), vec3(1, 1, 0),
+	vec3(0, 0, 1), vec3(0, 1, 1), vec3(1, 1, 1), vec3(1, 0, 1),
+	vec3(0, 0, 0), vec3(0, 1, 0), vec3(0, 1, 1), vec3(0, 0, 1),
+	vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 0, 0), vec3(0, 0, 0),
+	vec3(1, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0), vec3(0, 0, 0)
+};
+
 vec2 uvs[4] = {
 	vec2(0, 0),
 	vec2(0, 1),
@@ -22,17 +33,22 @@ vec2 uvs[4] = {
 void main() {
 	uint data = in_data;
 	
-	uint in_x = data & 63; data >>= 6;
-	uint in_y = data & 63; data >>= 6;
-	uint in_z = data & 63; data >>= 6;
+	uint pos_mask = (1u << log_chunk_size) - 1u;
+	
+	uint in_x = data & pos_mask; data >>= log_chunk_size;
+	uint in_y = data & pos_mask; data >>= log_chunk_size;
+	uint in_z = data & pos_mask; data >>= log_chunk_size;
 	
 	uint in_normal = data & 7; data >>= 3;
 	uint in_ao = data & 3; data >>= 2;
 	uint in_tex_id = data;
 
-	float x = float(in_x) - 16;
-	float y = float(in_y) - 16;
-	float z = float(in_z) - 16;
+	vec3 corner = corners[in_normal * 4 + gl_VertexID % 4];
+	float half_size = float(1u << log_chunk_size) / 2;
+
+	float x = float(in_x) + corner.x - half_size;
+	float y = float(in_y) + corner.y - half_size;
+	float z = float(in_z) + corner.z - half_size;
 
     gl_Position = MVP * vec4(x, y, z, 1.0f);
 	
@@ -1,4 +1,5 @@
 #include "client/GL/mesh.hpp"
+#include "world/chunk/chunk.hpp"
 
 namespace cybrion::GL
 {
@@ -60,15 +61,67 @@ namespace cybrion::GL
         }
     }
 
+    void Mesh::setVerticesSubData(u32 offset, const void *data, u32 size)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
+    void Mesh::reallocateVertices(u32 size, const vector<BufferMove> &moves)
+    {
+        GLuint vbo;
+        glGenBuffers(1, &vbo);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, m_vbo);
+        for (auto &move : moves)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from, move.to, move.size);
+
+        glDeleteBuffers(1, &m_vbo);
+        m_vbo = vbo;
+        m_maxBufferSize = size;
+
+        applyAttributes();
+    }
+
     void Mesh::setDrawCount(u32 drawCount)
     {
+        m_rangeCounts.clear();
+        m_rangeIndices.clear();
+        m_rangeBaseVertices.clear();
         m_drawCount = drawCount;
     }
 
+    void Mesh::setDrawRanges(const vector<DrawRange> &ranges)
+    {
+        m_rangeCounts.clear();
+        m_rangeIndices.clear();
+        m_rangeBaseVertices.clear();
+        m_drawCount = 0;
+
+        for (auto &range : ranges)
+        {
+            if (range.count == 0)
+                continue;
+
+            // every range starts at the first quad of the global indices
+            m_rangeCounts.push_back(range.count / 4 * 6);
+            m_rangeIndices.push_back(nullptr);
+            m_rangeBaseVertices.push_back(range.first);
+            m_drawCount += range.count / 4 * 6;
+        }
+    }
+
     void Mesh::drawTriangles() const
     {
         glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, m_drawCount, GL_UNSIGNED_INT, (void *)0);
+
+        if (m_rangeCounts.empty())
+            glDrawElements(GL_TRIANGLES, m_drawCount, GL_UNSIGNED_INT, (void *)0);
+        else
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_rangeCounts.data(), GL_UNSIGNED_INT, m_rangeIndices.data(), m_rangeCounts.size(), m_rangeBaseVertices.data());
     }
 
     void Mesh::drawLines() const
@@ -78,18 +131,24 @@ namespace cybrion::GL
     }
 
     void Mesh::setAttributes(std::initializer_list<MeshAttribute> attributes)
+    {
+        m_attributes = attributes;
+        applyAttributes();
+    }
+
+    void Mesh::applyAttributes()
     {
         u32 index = 0;
         u32 offset = 0;
         u32 stride = 0;
 
-        for (auto &attr : attributes)
+        for (auto &attr : m_attributes)
             stride += GetTypeSize(attr.type);
 
         glBindVertexArray(m_vao);
         glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 
-        for (auto &attr : attributes)
+        for (auto &attr : m_attributes)
         {
             u32 elementCount = GetElementCount(attr.type);
             u32 size = GetTypeSize(attr.type);
@@ -204,7 +263,8 @@ namespace cybrion::GL
     {
         glGenBuffers(1, &s_globalIBO);
 
-        constexpr u32 MAX_TRIANGLES = 32 * 32 * 32 * 3;
+        // a checkerboard chunk shows all six faces of half its blocks
+        constexpr u32 MAX_TRIANGLES = Chunk::CHUNK_VOLUME * 3;
 
         std::vector<u32> indices;
         for (u32 i = 0; i < MAX_TRIANGLES; ++i)
@@ -19,6 +19,22 @@ namespace cybrion::GL
         Type type;
     };
 
+    // range of the old vertex buffer copied into the new one, in bytes
+    struct BufferMove
+    {
+        u32 from;
+        u32 to;
+        u32 size;
+    };
+
+    // part of the vertex buffer drawn with the global indices, in vertices,
+    // first must be a multiple of 4 as shaders use gl_VertexID % 4
+    struct DrawRange
+    {
+        u32 first;
+        u32 count;
+    };
+
     class Mesh : public Transform
     {
     public:
@@ -44,6 +60,15 @@ namespace cybrion::GL
             setVerticesData(vertices, count * sizeof(T));
         }
 
+        // write into the buffer without resizing it, offsets in bytes
+        void setVerticesSubData(u32 offset, const void *data, u32 size);
+        // new buffer of size bytes with ranges of the old one copied over on
+        // the gpu, the rest is undefined
+        void reallocateVertices(u32 size, const vector<BufferMove> &moves);
+        // draw only these ranges in one call, the draw count becomes their
+        // index total until the next setDrawCount
+        void setDrawRanges(const vector<DrawRange> &ranges);
+
         u32 getDrawCount() const;
 
         void setIndices(u32 *indices, u32 count);
@@ -56,6 +81,8 @@ namespace cybrion::GL
         static void GenerateGlobalIBO();
 
     private:
+        void applyAttributes();
+
         static GLuint ToGLType(Type type);
         static u32 GetElementCount(Type type);
         static u32 GetTypeSize(Type type);
@@ -69,5 +96,11 @@ namespace cybrion::GL
         u32 m_maxBufferSize;
         u32 m_maxIndicesCount;
         bool m_useGlobalIBO;
+        // kept to point the vertex array at a reallocated buffer
+        vector<MeshAttribute> m_attributes;
+        // arguments of glMultiDrawElementsBaseVertex, empty for a single draw
+        vector<GLsizei> m_rangeCounts;
+        vector<const void *> m_rangeIndices;
+        vector<GLint> m_rangeBaseVertices;
     };
 }
\ No newline at end of file
@@ -438,6 +438,11 @@ namespace cybrion
         return m_rootPath + "/saves/" + path;
     }
 
+    string Application::getSettingsPath() const
+    {
+        return m_rootPath + "/settings.jbt";
+    }
+
     f32 Application::getFPS() const
     {
         return m_fps;
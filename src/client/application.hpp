@@ -50,6 +50,8 @@ namespace cybrion
         ShaderManager &getShaderManager();
         string getResourcePath(const string &path) const;
         string getSavePath(const string &path) const;
+        // user settings shared by every world
+        string getSettingsPath() const;
 
         f32 getFPS() const;
         f32 getDeltaTime() const;
@@ -1,4 +1,5 @@
 #include "client/graphic/block_renderer.hpp"
+#include "world/chunk/chunk.hpp"
 
 namespace cybrion
 {
@@ -143,9 +144,9 @@ namespace cybrion
                 else
                     ao = 3 - (o1 + o2 + o3);
 
-                ivec3 pos = ivec3(CubeVertices[i][j] + vec3(0.5f, 0.5f, 0.5f)) + position;
+                // the shader adds the corner offset from the normal and vertex index
                 result.push_back(packCubeVertex(
-                    pos.x, pos.y, pos.z,
+                    position.x, position.y, position.z,
                     i, ao,
                     m_cubeTexture[i][j].textureId
                 ));
@@ -260,12 +261,15 @@ namespace cybrion
 
     u32 BlockRenderer::packCubeVertex(u32 x, u32 y, u32 z, u32 normal, u32 ao, u32 texId)
     {
+        constexpr u32 POS_BITS = Chunk::LOG_2_CHUNK_SIZE;
+        CYBRION_ASSERT(texId < (1u << (32 - POS_BITS * 3 - 5)), "Texture id does not fit in cube vertex");
+
         u32 n = texId;
         n = n << 2 | ao;
         n = n << 3 | normal;
-        n = n << 6 | z;
-        n = n << 6 | y;
-        n = n << 6 | x;
+        n = n << POS_BITS | z;
+        n = n << POS_BITS | y;
+        n = n << POS_BITS | x;
         return n;
     }
 }
\ No newline at end of file
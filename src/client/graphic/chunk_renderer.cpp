@@ -1,5 +1,6 @@
 #include "client/graphic/chunk_renderer.hpp"
 #include "client/local_game.hpp"
+#include "core/timing_stat.hpp"
 
 namespace cybrion
 {
@@ -12,7 +13,9 @@ namespace cybrion
         modelMesh(true),
         m_inBuildQueue(false),
         m_version(0),
-        m_hasBuilt(false)
+        m_dirtyBricks(Chunk::AllBricks()),
+        m_hasBuilt(false),
+        m_builtChunkVersion(0)
     {
         opaqueMesh.setAttributes({
             { GL::Type::UINT }, // packed_vertex
@@ -30,23 +33,172 @@ namespace cybrion
         });
     }
     
-    ref<ChunkMeshResult> ChunkRenderer::buildChunkMesh()
+    ref<ChunkMeshResult> ChunkRenderer::buildChunkMesh(const ChunkSnapshot& snapshot, const Chunk::BrickMask& bricks)
     {
         auto result = std::make_shared<ChunkMeshResult>();
+        result->chunkVersion = snapshot.getVersion();
         
         Stopwatch stopwatch;
         stopwatch.reset();
 
-        bool culling[6] = { 0 };
-        Block::Block3x3x3 blocks;
+        // skipped bricks still get an empty section to clear what they had
+        bool skip = canSkipMeshing(snapshot);
+
+        for (i32 index = 0; index < Chunk::BRICK_COUNT; ++index)
+        {
+            if (!bricks.test(index))
+                continue;
 
-        m_chunk->eachBlocks([&](Block& block, const ivec3& pos){
-            // dont render transparent blocks like air
-            if (block.getDisplay() == BlockDisplay::TRANSPARENT)
-                return;
+            auto& section = result->sections.emplace_back(index, ChunkMeshSection()).second;
+            ivec3 brickPos = Chunk::brickIndexToPos(index);
+
+            if (skip || !snapshot.isBrickVisible(brickPos))
+                continue;
+
+            snapshot.eachBlocksInBrick(brickPos, [&](Block& block, const ivec3& pos){
+                buildBlockMesh(snapshot, block, pos, section);
+            });
+        }
+
+        updateMeshPositions();
+
+        if (!skip)
+        {
+            static auto &meshStat = GetTimingStat("Chunk mesh");
+            meshStat.add(stopwatch.getDeltaTime());
+        }
+        
+        return result;
+    }
+
+    template <typename T>
+    void ChunkMeshLayout::install(GL::Mesh& mesh, const vector<std::pair<u32, const vector<T>*>>& sections)
+    {
+        // make room for every section that outgrows its range at once
+        u32 growth = 0;
+        for (auto& [index, vertices] : sections)
+            if (vertices->size() > ranges[index].capacity)
+                growth += Capacity(vertices->size());
+
+        if (end + growth > bufferSize)
+            repack(mesh, sections);
+
+        for (auto& [index, vertices] : sections)
+            update(mesh, index, *vertices);
+
+        updateDrawRanges(mesh);
+    }
+
+    template <typename T>
+    void ChunkMeshLayout::update(GL::Mesh& mesh, u32 index, const vector<T>& vertices)
+    {
+        Range& range = ranges[index];
+        u32 count = vertices.size();
+
+        // the old range becomes a hole until the next repack
+        if (count > range.capacity)
+        {
+            range.offset = end;
+            range.capacity = Capacity(count);
+            end += range.capacity;
+        }
 
-            auto& cubeRenderer = LocalGame::Get().getBlockRenderer(block.getId());
+        if (count > 0)
+            mesh.setVerticesSubData(range.offset * sizeof(T), vertices.data(), count * sizeof(T));
 
+        range.count = count;
+    }
+
+    template <typename T>
+    void ChunkMeshLayout::repack(GL::Mesh& mesh, const vector<std::pair<u32, const vector<T>*>>& sections)
+    {
+        array<u32, Chunk::BRICK_COUNT> counts;
+        Chunk::BrickMask rebuilt;
+
+        for (u32 i = 0; i < Chunk::BRICK_COUNT; ++i)
+            counts[i] = ranges[i].count;
+
+        for (auto& [index, vertices] : sections)
+        {
+            counts[index] = vertices->size();
+            rebuilt[index] = true;
+        }
+
+        u32 spare = 0;
+        for (u32 count : counts)
+            spare += Capacity(count);
+        bool tight = spare > MAX_VERTICES;
+
+        vector<GL::BufferMove> moves;
+        u32 offset = 0;
+
+        for (u32 i = 0; i < Chunk::BRICK_COUNT; ++i)
+        {
+            Range& range = ranges[i];
+
+            // rebuilt sections are written right after, the rest is copied
+            if (rebuilt[i])
+                range.count = 0;
+            else if (range.count > 0)
+                moves.push_back({ u32(range.offset * sizeof(T)), u32(offset * sizeof(T)), u32(range.count * sizeof(T)) });
+
+            range.offset = offset;
+            range.capacity = tight ? counts[i] : Capacity(counts[i]);
+            offset += range.capacity;
+        }
+
+        end = offset;
+        bufferSize = std::max(end, std::min(MAX_VERTICES, end * 3 / 2));
+
+        mesh.reallocateVertices(bufferSize * sizeof(T), moves);
+    }
+
+    void ChunkMeshLayout::updateDrawRanges(GL::Mesh& mesh) const
+    {
+        vector<GL::DrawRange> draws;
+
+        for (auto& range : ranges)
+            if (range.count > 0)
+                draws.push_back({ range.offset, range.count });
+
+        mesh.setDrawRanges(draws);
+    }
+
+    u32 ChunkMeshLayout::Capacity(u32 count)
+    {
+        // a quarter more, rounded up to whole quads
+        return (count + count / 4 + 3) / 4 * 4;
+    }
+
+    void ChunkRenderer::installSections(ChunkMeshResult& result)
+    {
+        vector<std::pair<u32, const vector<u32>*>> opaqueSections;
+        vector<std::pair<u32, const vector<u32>*>> transparentSections;
+        vector<std::pair<u32, const vector<BlockVertex>*>> modelSections;
+
+        for (auto& [index, section] : result.sections)
+        {
+            opaqueSections.push_back({ index, &section.opaqueVertices });
+            transparentSections.push_back({ index, &section.transparentVertices });
+            modelSections.push_back({ index, &section.modelVertices });
+        }
+
+        m_opaqueLayout.install(opaqueMesh, opaqueSections);
+        m_transparentLayout.install(transparentMesh, transparentSections);
+        m_modelLayout.install(modelMesh, modelSections);
+    }
+
+    void ChunkRenderer::buildBlockMesh(const ChunkSnapshot& snapshot, Block& block, const ivec3& pos, ChunkMeshSection& section) const
+    {
+        // dont render transparent blocks like air
+        if (block.getDisplay() == BlockDisplay::TRANSPARENT)
+            return;
+
+        auto& cubeRenderer = LocalGame::Get().getBlockRenderer(block.getId());
+
+        if (block.getShape() == BlockShape::CUBE)
+        {
+            bool culling[6] = { 0 };
             bool visible = false;
 
             // block that is not visible now
@@ -56,56 +208,85 @@ namespace cybrion
             // we can use simple block getter when block is not in chunk border
             bool inBorder = Chunk::isInBorder(pos);
 
-            if (block.getShape() == BlockShape::CUBE)
+            for (auto& [dir, face] : BlockRenderer::CubeDirections)
             {
-                for (auto& [dir, face] : BlockRenderer::CubeDirections)
-                {
-                    Block* neighbor = inBorder
-                        ? std::get<0>(m_chunk->tryGetBlockMaybeOutside(pos + dir))
-                        : m_chunk->tryGetBlock(pos + dir);
-
-                    // cull this face when neighbor block is opaque
-                    culling[u32(face)] = !neighbor
-                        || (neighbor && neighbor->getDisplay() == BlockDisplay::OPAQUE)
-                        || (neighbor && neighbor->getDisplay() == BlockDisplay::LIQUID && block.getDisplay() == BlockDisplay::LIQUID);
-                    culling[u32(face)] &= !neighbor || neighbor->getShape() == BlockShape::CUBE;
-                    visible |= !culling[u32(face)];
-                    maybeVisible |= !neighbor;
-                }
+                Block* neighbor = inBorder
+                    ? snapshot.tryGetBlockMaybeOutside(pos + dir)
+                    : &snapshot.getBlock(pos + dir);
 
-                if (visible)
-                {
-                    if (inBorder)
-                        m_chunk->getBlockAndNeighborsMaybeOutside(pos, blocks);
-                    else
-                        m_chunk->getBlockAndNeighbors(pos, blocks);
-
-                    if (block.getDisplay() == BlockDisplay::LIQUID)
-                        cubeRenderer.generateCubeMesh(culling, pos, blocks, result->transparentVertices);
-                    else
-                        cubeRenderer.generateCubeMesh(culling, pos, blocks, result->opaqueVertices);
-                }
+                // cull this face when neighbor block is opaque
+                culling[u32(face)] = !neighbor
+                    || (neighbor && neighbor->getDisplay() == BlockDisplay::OPAQUE)
+                    || (neighbor && neighbor->getDisplay() == BlockDisplay::LIQUID && block.getDisplay() == BlockDisplay::LIQUID);
+                culling[u32(face)] &= !neighbor || neighbor->getShape() == BlockShape::CUBE;
+                visible |= !culling[u32(face)];
+                maybeVisible |= !neighbor;
             }
-            else
+
+            if (visible)
             {
-                auto meshes = block.getMeshes();
+                Block::Block3x3x3 blocks;
+
+                if (inBorder)
+                    snapshot.getBlockAndNeighborsMaybeOutside(pos, blocks);
+                else
+                    snapshot.getBlockAndNeighbors(pos, blocks);
+
+                if (block.getDisplay() == BlockDisplay::LIQUID)
+                    cubeRenderer.generateCubeMesh(culling, pos, blocks, section.transparentVertices);
+                else
+                    cubeRenderer.generateCubeMesh(culling, pos, blocks, section.opaqueVertices);
+            }
+        }
+        else
+        {
+            auto meshes = block.getMeshes();
 
-                for (auto mesh : meshes)
+            for (auto mesh : meshes)
+            {
+                for (auto vertex : mesh->vertices)
                 {
-                    for (auto vertex : mesh->vertices)
-                    {
-                        vertex.texId = block.getModelTexture(vertex.texId);
-                        vertex.pos += vec3(pos) + vec3(
-                            0.5f - Chunk::CHUNK_SIZE / 2,
-                            0.5f - Chunk::CHUNK_SIZE / 2,
-                            0.5f - Chunk::CHUNK_SIZE / 2
-                        );
-                        result->modelVertices.push_back(vertex);
-                    }
+                    vertex.texId = block.getModelTexture(vertex.texId);
+                    vertex.pos += vec3(pos) + vec3(
+                        0.5f - Chunk::CHUNK_SIZE / 2,
+                        0.5f - Chunk::CHUNK_SIZE / 2,
+                        0.5f - Chunk::CHUNK_SIZE / 2
+                    );
+                    section.modelVertices.push_back(vertex);
                 }
             }
-        });
+        }
+    }
+
+    bool ChunkRenderer::canSkipMeshing(const ChunkSnapshot& snapshot) const
+    {
+        Block* block = snapshot.getUniformBlock({ 0, 0, 0 });
 
+        // chunk full of air
+        if (block && block->getDisplay() == BlockDisplay::TRANSPARENT)
+            return true;
+
+        // any mix of opaque cubes counts as solid, not only uniform chunks
+        if (!snapshot.getContents({ 0, 0, 0 })->isAllOpaque())
+            return false;
+
+        // solid chunk is only visible through a face neighbor that is not solid too
+        for (auto& [dir, face] : BlockRenderer::CubeDirections)
+        {
+            auto contents = snapshot.getContents(dir);
+
+            if (!contents)
+                continue;
+
+            if (!contents->isAllOpaque())
+                return false;
+        }
+
+        return true;
+    }
+
+    void ChunkRenderer::updateMeshPositions()
+    {
         opaqueMesh.setPos(m_chunk->getPos());
         opaqueMesh.updateModelMat();
 
@@ -114,8 +295,6 @@ namespace cybrion
 
         modelMesh.setPos(m_chunk->getPos());
         modelMesh.updateModelMat();
-        
-        return result;
     }
 
     void ChunkRenderer::rebuildChunkMesh()
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "world/chunk/chunk.hpp"
+#include "world/chunk/chunk_snapshot.hpp"
+#include "world/chunk/chunk_job_scheduler.hpp"
 #include "client/GL/mesh.hpp"
 #include "client/graphic/block_renderer.hpp"
 
@@ -15,13 +17,58 @@ namespace cybrion
         RUNNING
     };
 
-    struct ChunkMeshResult
+    // vertices of one brick, the chunk mesh is all sections put together
+    struct ChunkMeshSection
     {
         vector<u32> opaqueVertices;
         vector<u32> transparentVertices;
         vector<BlockVertex> modelVertices;
+    };
+
+    // where the vertices of each brick are in a mesh's vertex buffer, ranges
+    // keep spare room so most rebuilds overwrite their own range in place,
+    // only the vertices of each range are drawn, never the room or holes
+    struct ChunkMeshLayout
+    {
+        struct Range
+        {
+            u32 offset = 0;
+            u32 capacity = 0;
+            u32 count = 0;
+        };
+
+        // in vertices, end includes the holes left by moved ranges
+        array<Range, Chunk::BRICK_COUNT> ranges;
+        u32 end = 0;
+        u32 bufferSize = 0;
+
+        template <typename T>
+        void install(GL::Mesh &mesh, const vector<std::pair<u32, const vector<T> *>> &sections);
+
+    private:
+        template <typename T>
+        void update(GL::Mesh &mesh, u32 index, const vector<T> &vertices);
+        // compact the kept ranges into a new buffer with the rebuilt sections
+        // placed too, without spare room when a crowded chunk would not fit
+        template <typename T>
+        void repack(GL::Mesh &mesh, const vector<std::pair<u32, const vector<T> *>> &sections);
+        void updateDrawRanges(GL::Mesh &mesh) const;
+
+        // vertices reserved for a range of count, whole quads
+        static u32 Capacity(u32 count);
+
+        // the global index buffer covers this many vertices, a chunk never
+        // needs more
+        static constexpr u32 MAX_VERTICES = Chunk::CHUNK_VOLUME * 3 * 4;
+    };
+
+    struct ChunkMeshResult
+    {
+        // only the bricks that were rebuilt
+        vector<std::pair<u32, ChunkMeshSection>> sections;
         ref<ChunkRenderer> renderer;
         u32 version;
+        u32 chunkVersion;
     };
 
     struct ChunkRenderer
@@ -37,9 +84,30 @@ namespace cybrion
         std::atomic<bool> m_inBuildQueue;
         std::atomic<u32> m_version;
 
+        // latest snapshot waiting for the queued build
+        std::mutex m_snapshotLock;
+        ref<ChunkSnapshot> m_snapshot;
+        // bricks to rebuild, kept until a build of them is installed
+        Chunk::BrickMask m_dirtyBricks;
+
+        // last submitted build, only used on the main thread
+        ref<ChunkJob> m_buildJob;
+
         bool m_hasBuilt;
+        u32 m_builtChunkVersion;
 
-        ref<ChunkMeshResult> buildChunkMesh();
+        // ranges of the bricks in the meshes, only used on the main thread
+        ChunkMeshLayout m_opaqueLayout;
+        ChunkMeshLayout m_transparentLayout;
+        ChunkMeshLayout m_modelLayout;
+
+        ref<ChunkMeshResult> buildChunkMesh(const ChunkSnapshot& snapshot, const Chunk::BrickMask& bricks);
+        // upload the rebuilt sections over their old ranges
+        void installSections(ChunkMeshResult& result);
         void rebuildChunkMesh();
+
+        void buildBlockMesh(const ChunkSnapshot& snapshot, Block& block, const ivec3& pos, ChunkMeshSection& section) const;
+        bool canSkipMeshing(const ChunkSnapshot& snapshot) const;
+        void updateMeshPositions();
     };
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ namespace cybrion
     WorldRenderer::WorldRenderer(World &world) : m_world(world),
                                                  m_enableAO(true),
                                                  m_enableDiffuse(true),
+                                                 m_drawCalls(0),
                                                  m_chunkMeshResults()
     {
         m_basicShader = ShaderManager::Get().getShader<BasicShader>("basic");
@@ -37,16 +38,16 @@ namespace cybrion
             if (renderer->m_version != result->version)
                 continue;
 
-            renderer->opaqueMesh.setVertices(result->opaqueVertices.data(), result->opaqueVertices.size());
-            renderer->opaqueMesh.setDrawCount(result->opaqueVertices.size() / 4 * 6);
-
-            renderer->transparentMesh.setVertices(result->transparentVertices.data(), result->transparentVertices.size());
-            renderer->transparentMesh.setDrawCount(result->transparentVertices.size() / 4 * 6);
+            {
+                // no rebuild was asked since this one, it covered every dirty brick
+                std::lock_guard<std::mutex> lock(renderer->m_snapshotLock);
+                renderer->m_dirtyBricks.reset();
+            }
 
-            renderer->modelMesh.setVertices(result->modelVertices.data(), result->modelVertices.size());
-            renderer->modelMesh.setDrawCount(result->modelVertices.size() / 4 * 6);
+            renderer->installSections(*result);
 
             renderer->m_hasBuilt = true;
+            renderer->m_builtChunkVersion = result->chunkVersion;
 
             ++cnt;
         }
@@ -55,7 +56,14 @@ namespace cybrion
             vector<u32> removeList;
             for (auto &[id, renderer] : m_chunkRenderers)
             {
-                if (renderer->m_chunk->isUnloaded() && renderer.use_count() == 1)
+                if (!renderer->m_chunk->isUnloaded())
+                    continue;
+
+                // a queued build holds the renderer, drop it instead of waiting
+                GetChunkJobScheduler().cancel(renderer->m_buildJob);
+                renderer->m_buildJob = nullptr;
+
+                if (renderer.use_count() == 1)
                     removeList.push_back(id);
             }
             for (auto &id : removeList)
@@ -67,6 +75,9 @@ namespace cybrion
         m_opaqueCubeShader.use();
         m_opaqueCubeShader.setUniform<"enable_diffuse">((u32)m_enableDiffuse);
         m_opaqueCubeShader.setUniform<"enable_ao">((u32)m_enableAO);
+        m_opaqueCubeShader.setUniform<"log_chunk_size">((u32)Chunk::LOG_2_CHUNK_SIZE);
+
+        m_drawCalls = 0;
 
         vector<ref<ChunkRenderer>> renderChunks;
         for (auto &[id, renderer] : m_chunkRenderers)
@@ -98,6 +109,7 @@ namespace cybrion
                 glCullFace(GL_FRONT);
 
                 opaqueMesh.drawTriangles();
+                ++m_drawCalls;
 
                 glDisable(GL_CULL_FACE);
             }
@@ -108,6 +120,7 @@ namespace cybrion
                 glEnable(GL_BLEND);
                 glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 transparentMesh.drawTriangles();
+                ++m_drawCalls;
                 glDisable(GL_BLEND);
             }
         }
@@ -123,6 +136,7 @@ namespace cybrion
             if (modelMesh.getDrawCount() > 0)
             {
                 modelMesh.drawTriangles();
+                ++m_drawCalls;
             }
         }
 
@@ -146,16 +160,20 @@ namespace cybrion
 
         auto renderer = std::make_shared<ChunkRenderer>(chunk);
         m_chunkRenderers[chunk->getId()] = renderer;
-        prepareRebuild(renderer);
 
-        chunk->eachNeighbors([this](ref<Chunk> &neighbor, const ivec3 &)
+        // the first build covers every brick, edits until now are part of it
+        chunk->takeDirtyBricks();
+        prepareRebuild(renderer, Chunk::AllBricks());
+
+        // only the bricks of the neighbors that face this chunk can change
+        chunk->eachNeighbors([this](ref<Chunk> &neighbor, const ivec3 &dir)
                              {
             if (neighbor && neighbor->hasStructure())
             {
                 auto renderer = getChunkRenderer(neighbor);
 
                 if (renderer)
-                    prepareRebuild(renderer);
+                    prepareRebuild(renderer, Chunk::BorderBricks(-dir));
             } });
     }
 
@@ -181,31 +199,55 @@ namespace cybrion
         return it == m_entityRenderers.end() ? nullptr : it->second;
     }
 
-    void WorldRenderer::prepareRebuild(const ref<ChunkRenderer> &renderer)
+    void WorldRenderer::prepareRebuild(const ref<ChunkRenderer> &renderer, const Chunk::BrickMask &bricks, bool urgent)
     {
         if (renderer->m_chunk->isUnloaded())
             return;
 
-        if (renderer->m_inBuildQueue)
-            return;
+        // workers never read live chunks, they mesh this snapshot
+        auto snapshot = std::make_shared<ChunkSnapshot>(*renderer->m_chunk);
 
-        renderer->m_inBuildQueue = true;
-        renderer->m_version += 1;
+        {
+            std::lock_guard<std::mutex> lock(renderer->m_snapshotLock);
 
-        u32 version = renderer->m_version;
+            // a queued build picks up the newest snapshot
+            renderer->m_snapshot = snapshot;
+            renderer->m_version += 1;
+            renderer->m_dirtyBricks |= bricks;
 
-        std::ignore = GetPool().submit(
-            [this, renderer, version]
+            if (renderer->m_inBuildQueue)
+            {
+                if (urgent)
+                    GetChunkJobScheduler().promote(renderer->m_buildJob);
+                return;
+            }
+
+            renderer->m_inBuildQueue = true;
+        }
+
+        renderer->m_buildJob = GetChunkJobScheduler().submit(
+            ChunkJobStage::MESH, renderer->m_chunk->getChunkPos(),
+            [this, renderer]
             {
                 if (!Application::Get().isPlayingGame())
                     return;
 
-                renderer->m_inBuildQueue = false;
+                ref<ChunkSnapshot> snapshot;
+                Chunk::BrickMask bricks;
+                u32 version;
+
+                {
+                    std::lock_guard<std::mutex> lock(renderer->m_snapshotLock);
+                    snapshot = std::move(renderer->m_snapshot);
+                    bricks = renderer->m_dirtyBricks;
+                    version = renderer->m_version;
+                    renderer->m_inBuildQueue = false;
+                }
 
                 if (renderer->m_chunk->isUnloaded())
                     return;
 
-                auto result = renderer->buildChunkMesh();
+                auto result = renderer->buildChunkMesh(*snapshot, bricks);
                 result->renderer = renderer;
                 result->version = version;
 
@@ -218,7 +260,8 @@ namespace cybrion
                 // allow to install if version is still latest after building
                 if (version == renderer->m_version)
                     m_chunkMeshResults.enqueue(result);
-            });
+            },
+            urgent);
     }
 
     void WorldRenderer::updateBlock(const BlockModifyResult &result)
@@ -272,8 +315,16 @@ namespace cybrion
         if (renderer == nullptr)
             return;
 
-        if (renderer->m_chunk->hasStructure())
-            prepareRebuild(renderer);
+        if (!renderer->m_chunk->hasStructure())
+            return;
+
+        auto bricks = chunk->takeDirtyBricks();
+
+        if (bricks.none())
+            return;
+
+        // a chunk already on screen changed, show the edit first
+        prepareRebuild(renderer, bricks, renderer->m_hasBuilt);
     }
 
     void WorldRenderer::updateEntityRenderers(f32 delta)
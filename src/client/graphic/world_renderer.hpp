@@ -16,7 +16,7 @@ namespace cybrion::ui
 
 namespace cybrion
 {
-    using OpaqueCubeShader = GL::Shader<"MVP", "enable_diffuse", "enable_ao">;
+    using OpaqueCubeShader = GL::Shader<"MVP", "enable_diffuse", "enable_ao", "log_chunk_size">;
     using BlockModelShader = GL::Shader<"MVP">;
     using BasicShader = GL::Shader<"MVP">;
     using BasicBlockShader = GL::Shader<"MVP", "use_light">;
@@ -36,7 +36,9 @@ namespace cybrion
         ref<EntityRenderer> getEntityRenderer(const ref<Entity> &entity) const;
         ref<ChunkRenderer> getChunkRenderer(const ref<Chunk> &chunk) const;
 
-        void prepareRebuild(const ref<ChunkRenderer> &renderer);
+        // only the given bricks are remeshed, urgent builds skip ahead of
+        // chunks that have not been shown yet
+        void prepareRebuild(const ref<ChunkRenderer> &renderer, const Chunk::BrickMask &bricks, bool urgent = false);
         void updateBlock(const BlockModifyResult &result);
         void updateChunk(const ref<Chunk> &chunk);
 
@@ -62,6 +64,9 @@ namespace cybrion
         bool m_enableAO;
         bool m_enableDiffuse;
 
+        // chunk draw calls issued by the last frame
+        u32 m_drawCalls;
+
         moodycamel::ConcurrentQueue<ref<ChunkMeshResult>> m_chunkMeshResults;
     };
 }
\ No newline at end of file
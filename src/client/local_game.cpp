@@ -9,7 +9,7 @@ namespace cybrion
 {
     LocalGame *LocalGame::s_LocalGame = nullptr;
 
-    LocalGame::LocalGame(const string &worldPath) : Game(worldPath),
+    LocalGame::LocalGame(const string &worldPath) : Game(Application::Get().getResourcePath(""), worldPath),
                                                     m_camera(Application::Get().getAspect(), glm::radians(50.0f), 0.0001f, 1500.0f),
                                                     m_showWireframe(false),
                                                     m_showEntityBorder(false),
@@ -25,6 +25,7 @@ namespace cybrion
     void LocalGame::load()
     {
         Game::load();
+        getWorld().setSettings(WorldSettings::Load(Application::Get().getSettingsPath()));
         createBlockRenderers();
 
         m_basicShader = ShaderManager::Get().getShader<BasicShader>("basic");
@@ -1,6 +1,5 @@
 #include "block_loader.hpp"
 
-#include "client/application.hpp"
 #include "util/file.hpp"
 
 #define _CONCAT(x, y) x##y
@@ -57,15 +56,15 @@ namespace cybrion
         return m_meshMap.find(name)->second;
     }
 
+#ifndef CYBRION_HEADLESS
     void BlockLoader::bindTextureArray()
     {
         m_textureArray.bind(0);
     }
+#endif
 
-    void BlockLoader::loadConfigFiles()
+    void BlockLoader::loadConfigFiles(const string &folderPath)
     {
-        string folderPath = Application::Get().getResourcePath("configs/blocks/");
-
         for (auto &entry : std::filesystem::directory_iterator(folderPath))
         {
             string path = entry.path().string();
@@ -75,10 +74,18 @@ namespace cybrion
         }
     }
 
-    void BlockLoader::loadTextures()
+    void BlockLoader::loadTextures(const string &folderPath)
     {
+#ifdef CYBRION_HEADLESS
+        for (auto &entry : std::filesystem::directory_iterator(folderPath))
+        {
+            string name = entry.path().stem().string();
+
+            if (entry.path().extension() == ".png")
+                m_textureIdMap[name] = nextTextureId(name);
+        }
+#else
         constexpr i32 BLOCK_TEXTURE_SIZE = 32;
-        string folderPath = Application::Get().getResourcePath("textures/blocks/");
 
         // count number of block textures
         u32 layerCount = 0;
@@ -125,7 +132,7 @@ namespace cybrion
                 data = new_data;
             }
 
-            u32 id = name == "no_texture" ? 0 : m_textureIdMap.size() + (m_textureIdMap.count("no_texture") == 0);
+            u32 id = nextTextureId(name);
             m_textureIdMap[name] = id;
 
             u8 *resizedData = (u8 *)malloc(BLOCK_TEXTURE_SIZE * BLOCK_TEXTURE_SIZE * 4);
@@ -140,12 +147,16 @@ namespace cybrion
             free(data);
             free(resizedData);
         }
+#endif
     }
 
-    void BlockLoader::loadModels()
+    u32 BlockLoader::nextTextureId(const string &name) const
     {
-        string folderPath = Application::Get().getResourcePath("models/blocks/");
+        return name == "no_texture" ? 0 : m_textureIdMap.size() + (m_textureIdMap.count("no_texture") == 0);
+    }
 
+    void BlockLoader::loadModels(const string &folderPath)
+    {
         for (auto &entry : std::filesystem::directory_iterator(folderPath))
         {
             string path = entry.path().string();
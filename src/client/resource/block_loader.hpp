@@ -1,6 +1,8 @@
 #pragma once
 
+#ifndef CYBRION_HEADLESS
 #include "client/GL/texture_array.hpp"
+#endif
 #include "world/block/block.hpp"
 
 namespace cybrion
@@ -11,15 +13,18 @@ namespace cybrion
 
         BlockLoader();
 
-        void loadConfigFiles();
-        void loadTextures();
-        void loadModels();
+        void loadConfigFiles(const string& folderPath);
+        // the headless build only assigns the texture ids
+        void loadTextures(const string& folderPath);
+        void loadModels(const string& folderPath);
 
         u32 getTextureId(const string& name);
 
         ref<BlockMesh> getMesh(const string& name) const;
 
+#ifndef CYBRION_HEADLESS
         void bindTextureArray();
+#endif
 
         static BlockLoader& Get();
 
@@ -32,7 +37,12 @@ namespace cybrion
 
         bool loadConfigFile(const string& path);
 
+        // no_texture is always 0
+        u32 nextTextureId(const string& name) const;
+
+#ifndef CYBRION_HEADLESS
         GL::TextureArray m_textureArray;
+#endif
         umap<string, u32> m_textureIdMap;
         umap<string, ref<BlockMesh>> m_meshMap;
     };
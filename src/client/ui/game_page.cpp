@@ -2,6 +2,8 @@
 #include "client/application.hpp"
 #include "client/ui/controls.hpp"
 #include "core/pool.hpp"
+#include "core/timing_stat.hpp"
+#include "core/object_pool.hpp"
 #include "player.hpp"
 #include "world/block/blocks.hpp"
 
@@ -237,6 +239,42 @@ namespace cybrion::ui
                 ImGui::Text("Holding: %s", heldBlock->getDisplayName().c_str());
             }
 
+            auto &world = game.getWorld();
+            ImGui::Text("Chunk memory: %.1f MB resident, %.1f MB frozen (%u chunks)",
+                        world.getResidentMemory() / 1048576.0f,
+                        world.getFrozenMemory() / 1048576.0f,
+                        world.getFrozenChunkCount());
+
+#ifdef CYBRION_MORTON_CHUNK_LAYOUT
+            ImGui::Text("Chunk layout: morton, %d^3", Chunk::CHUNK_SIZE);
+#else
+            ImGui::Text("Chunk layout: linear, %d^3", Chunk::CHUNK_SIZE);
+#endif
+            ImGui::Text("Chunk draw calls: %u", game.m_worldRenderer.m_drawCalls);
+
+            auto &scheduler = GetChunkJobScheduler();
+            ImGui::Text("Chunk jobs: %u generate, %u decorate, %u mesh, %u thaw",
+                        scheduler.getQueueDepth(ChunkJobStage::GENERATE),
+                        scheduler.getQueueDepth(ChunkJobStage::DECORATE),
+                        scheduler.getQueueDepth(ChunkJobStage::MESH),
+                        scheduler.getQueueDepth(ChunkJobStage::THAW));
+            ImGui::Text("Save size: %.2f MB", world.getSaveSize() / 1048576.0f);
+            ImGui::Text("Save queue: %u chunks, oldest %.1f s, %u unloads deferred",
+                        world.getSaveQueueSize(),
+                        world.getSaveQueueAge() / f32(TICKS_PER_SECOND),
+                        world.getDeferredUnloadCount());
+
+            EachTimingStat([](const string &name, TimingStat &stat)
+                           { ImGui::Text("%s: %.3f ms avg, %.3f ms max (%u)", name.c_str(), stat.getAverage(), stat.getMax(), stat.getCount()); });
+
+            EachObjectPool([](ObjectPool &pool)
+                           { ImGui::Text("%s: %u live, %u pooled, %llu heap, %llu reused",
+                                         pool.getName().c_str(),
+                                         pool.getLiveCount(),
+                                         pool.getPooledCount(),
+                                         (unsigned long long)pool.getHeapAllocationCount(),
+                                         (unsigned long long)pool.getReuseCount()); });
+
             ImGui::End();
 
             // render toolbox
@@ -254,6 +292,40 @@ namespace cybrion::ui
             ImGui::Checkbox("Enable diffuse", &game.m_worldRenderer.m_enableDiffuse);
             ImGui::Checkbox("Enable AO", &game.m_worldRenderer.m_enableAO);
 
+            WorldSettings settings = game.getWorld().getSettings();
+            i32 residentBudget = settings.residentMemoryBudget;
+            i32 loadedBudget = settings.loadedMemoryBudget;
+            bool changed = false;
+            bool edited = false;
+
+            changed |= ImGui::SliderInt("Load distance", &settings.loadDistance, 1, WorldSettings::MAX_DISTANCE);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+            changed |= ImGui::SliderInt("Unload distance", &settings.unloadDistance, 1, WorldSettings::MAX_DISTANCE);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+            changed |= ImGui::SliderInt("Vertical load distance", &settings.verticalLoadDistance, 1, WorldSettings::MAX_VERTICAL_DISTANCE);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+            changed |= ImGui::SliderInt("Vertical unload distance", &settings.verticalUnloadDistance, 1, WorldSettings::MAX_VERTICAL_DISTANCE);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+            changed |= ImGui::SliderInt("Chunk memory budget (MB)", &residentBudget, 16, 4096);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+            changed |= ImGui::SliderInt("Loaded chunk budget (MB, 0 = off)", &loadedBudget, 0, 8192);
+            edited |= ImGui::IsItemDeactivatedAfterEdit();
+
+            if (changed)
+            {
+                settings.residentMemoryBudget = residentBudget;
+                settings.loadedMemoryBudget = loadedBudget;
+                game.getWorld().setSettings(settings);
+            }
+
+            // write the file once a slider is released, not on every step
+            if (edited)
+                WorldSettings::Save(game.getWorld().getSettings(), app.getSettingsPath());
+
+            if (ImGui::Button("Reset stats"))
+                EachTimingStat([](const string &, TimingStat &stat)
+                               { stat.reset(); });
+
             ImGui::End();
         }
 
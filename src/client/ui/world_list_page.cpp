@@ -70,7 +70,7 @@ namespace cybrion::ui
         {
             if (isValidName(m_worldInput))
             {
-                World::createNewWorld(m_worldInput);
+                World::createNewWorld(Application::Get().getSavePath(m_worldInput), m_worldInput);
                 loadWorldList();
                 std::strcpy(m_worldInput, "");
             }
@@ -143,9 +143,13 @@ namespace cybrion::ui
             jbt::open_tag(config, configFile);
 
             i32 totalSize = 0;
-            for (const auto &region0 : std::filesystem::directory_iterator(entry.path().string() + "/region"))
+            string regionFolder = entry.path().string() + "/" + World::GetRegionDirectory();
+            if (std::filesystem::exists(regionFolder))
             {
-                totalSize += std::filesystem::file_size(region0.path().string());
+                for (const auto &region0 : std::filesystem::directory_iterator(regionFolder))
+                {
+                    totalSize += std::filesystem::file_size(region0.path().string());
+                }
             }
 
             WorldInfo info;
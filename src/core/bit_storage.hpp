@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/object_pool.hpp"
+
 namespace cybrion
 {
     class BitStorage
@@ -14,20 +16,20 @@ namespace cybrion
         virtual u32 get(const u32 &index) const = 0;
         virtual void set(const u32 &index, const u32 &value) = 0;
         virtual u32 getMaxValue() const = 0;
+        virtual u32 getBitExp() const = 0;
         virtual u32 getSize() const = 0;
         virtual void fromJBT(const jbt::byte_array_t &data) = 0;
         virtual jbt::byte_array_t toJBT() = 0;
-
-        void copyFrom(const BitStorage &other)
-        {
-            u32 size = getSize();
-            assert(size == other.getSize());
-
-            for (u32 i = 0; i < size; ++i)
-            {
-                set(i, other.get(i));
-            }
-        }
+        virtual BitStorage *clone() const = 0;
+        virtual const u32 *getData() const = 0;
+        virtual u32 getDataSize() const = 0;
+
+        // copy all entries of a storage of the same size but any bit width
+        virtual void copyFrom(const BitStorage &other) = 0;
+        // same as above, every entry is replaced by remap[entry]
+        virtual void copyFrom(const BitStorage &other, const u32 *remap) = 0;
+        // add the number of entries holding each value to counts
+        virtual void countValues(u32 *counts) const = 0;
     };
 
     template <u32 BIT_SIZE, u32 SIZE>
@@ -36,6 +38,27 @@ namespace cybrion
     public:
         virtual ~BitStorageImpl() = default;
 
+        static void *operator new(std::size_t size)
+        {
+            assert(size == sizeof(BitStorageImpl));
+            return GetObjectPool().allocate();
+        }
+
+        static void operator delete(void *ptr)
+        {
+            GetObjectPool().deallocate(ptr);
+        }
+
+        static ObjectPool &GetObjectPool()
+        {
+            // never destroyed, storages may still be freed during shutdown
+            static ObjectPool *pool = new ObjectPool(
+                "BitStorage " + std::to_string(BITS_PER_VALUE) + " bit x " + std::to_string(SIZE),
+                sizeof(BitStorageImpl),
+                MAX_POOLED_BYTES);
+            return *pool;
+        }
+
         void clear() override
         {
             std::memset(m_data, 0, sizeof(m_data));
@@ -73,6 +96,11 @@ namespace cybrion
             return MAX_VALUE;
         }
 
+        u32 getBitExp() const override
+        {
+            return BIT_SIZE;
+        }
+
         void fromJBT(const jbt::byte_array_t &data)
         {
             if (data.size)
@@ -92,7 +120,92 @@ namespace cybrion
             return data;
         }
 
+        BitStorage *clone() const override
+        {
+            return new BitStorageImpl(*this);
+        }
+
+        const u32 *getData() const override
+        {
+            return m_data;
+        }
+
+        u32 getDataSize() const override
+        {
+            return sizeof(m_data);
+        }
+
+        void copyFrom(const BitStorage &other) override
+        {
+            transcodeFrom(other, [](u32 value)
+                          { return value; });
+        }
+
+        void copyFrom(const BitStorage &other, const u32 *remap) override
+        {
+            transcodeFrom(other, [remap](u32 value)
+                          { return remap[value]; });
+        }
+
+        void countValues(u32 *counts) const override
+        {
+            for (u32 i = 0; i < TOTAL_INTS; ++i)
+            {
+                u32 word = m_data[i];
+
+                for (u32 k = 0; k < VALUES_PER_INT; ++k)
+                    counts[(word >> (k << BIT_SIZE)) & BIT_MASK] += 1;
+            }
+        }
+
     private:
+        template <typename F>
+        void transcodeFrom(const BitStorage &other, const F &map)
+        {
+            assert(other.getSize() == SIZE);
+
+            switch (other.getBitExp())
+            {
+            case 0:
+                return transcodeWords<0>(other.getData(), map);
+            case 1:
+                return transcodeWords<1>(other.getData(), map);
+            case 2:
+                return transcodeWords<2>(other.getData(), map);
+            case 3:
+                return transcodeWords<3>(other.getData(), map);
+            case 4:
+                return transcodeWords<4>(other.getData(), map);
+            case 5:
+                return transcodeWords<5>(other.getData(), map);
+            default:
+                assert(false);
+            }
+        }
+
+        // both widths are known here, so the inner loop has a fixed trip count
+        // and compiles to shifts and masks the compiler can unroll and vectorize
+        template <u32 SRC_BIT_SIZE, typename F>
+        void transcodeWords(const u32 *src, const F &map)
+        {
+            constexpr u32 SRC_VALUES_PER_INT = 32 >> SRC_BIT_SIZE;
+            constexpr u32 SRC_BIT_MASK = 0xFFFFFFFF >> (32 - (1 << SRC_BIT_SIZE));
+
+            for (u32 i = 0; i < TOTAL_INTS; ++i)
+            {
+                u32 word = 0;
+
+                for (u32 k = 0; k < VALUES_PER_INT; ++k)
+                {
+                    u32 index = i * VALUES_PER_INT + k;
+                    u32 value = (src[index / SRC_VALUES_PER_INT] >> ((index % SRC_VALUES_PER_INT) << SRC_BIT_SIZE)) & SRC_BIT_MASK;
+                    word |= map(value) << (k << BIT_SIZE);
+                }
+
+                m_data[i] = word;
+            }
+        }
+
         constexpr static u32 BITS_PER_VALUE = 1 << BIT_SIZE;
         constexpr static u32 FIVE_MINUS_BIT_SIZE = 5 - BIT_SIZE;
         constexpr static u32 VALUES_PER_INT = 32 >> BIT_SIZE;
@@ -100,6 +213,10 @@ namespace cybrion
         constexpr static u32 MAX_VALUE = 0xFFFFFFFF >> (32 - BITS_PER_VALUE);
         constexpr static u32 TOTAL_INTS = (SIZE * BITS_PER_VALUE + 31) >> 5;
         constexpr static u32 BIT_MASK = 0xFFFFFFFF >> (32 - BITS_PER_VALUE);
+        constexpr static u64 MAX_POOLED_BYTES = 32 * 1024 * 1024;
+
+        // whole words only, the word loops above rely on it
+        static_assert(SIZE % 32 == 0);
 
         u32 m_data[TOTAL_INTS];
     };
@@ -9,84 +9,285 @@ namespace cybrion
     class LinearPalette
     {
     public:
-        LinearPalette() : m_storage(nullptr), m_diffValues(1), m_valueToId{0}, m_bitExp(240404)
+        // read only copy sharing the storage, later writes to the palette
+        // clone the storage so the snapshot never changes
+        struct Snapshot
         {
-            m_valueToId[0] = 1;
-            m_idToValue.push_back(0);
-        }
+            vector<u32> idToValue;
+            ref<BitStorage> storage;
+
+            u32 get(const u32& index) const
+            {
+                if (storage == nullptr)
+                    return idToValue[0];
+
+                return idToValue[storage->get(index)];
+            }
+        };
 
-        ~LinearPalette()
+        LinearPalette() : m_storage(nullptr), m_diffValues(1), m_valueToId{0}, m_bitExp(0)
         {
-            if (m_storage)
-                delete m_storage;
+            m_valueToId[0] = 1;
+            m_idToValue.push_back(0);
+            m_counts.push_back(SIZE);
         }
 
         u32 get(const u32& index) const
         {
+            // no storage means every entry has the first palette value
             if (m_storage == nullptr)
-                return 0;
+                return m_idToValue[0];
 
             return m_idToValue[m_storage->get(index)];
         }
 
         void set(const u32& index, const u32& value)
         {
-            if (value == 0 && m_storage == nullptr)
+            if (m_storage == nullptr && value == m_idToValue[0])
                 return;
 
             assert(value < VALUE_SIZE);
-            auto& id = m_valueToId[value];
+            u32 id = m_valueToId[value];
 
-            if (id)
-                m_storage->set(index, id - 1);
-            else
-            {
-                u32 id = addValue(value);
-                m_storage->set(index, id - 1);
-            }
+            if (!id)
+                id = addValue(value);
+
+            detachStorage();
+
+            u32 oldId = m_storage->get(index);
+            m_storage->set(index, id - 1);
+
+            m_counts[oldId] -= 1;
+            m_counts[id - 1] += 1;
         }
 
         void reset()
         {
-            m_idToValue.clear();
-            delete m_storage;
+            fill(0);
+        }
+
+        // set all entries to a single value without allocating storage
+        void fill(const u32& value)
+        {
+            assert(value < VALUE_SIZE);
+
             m_storage = nullptr;
+
+            for (u32 v : m_idToValue)
+                m_valueToId[v] = 0;
+
+            m_idToValue.clear();
+            m_idToValue.push_back(value);
+            m_valueToId[value] = 1;
+            m_counts.assign(1, SIZE);
+            m_diffValues = 1;
+            m_bitExp = 0;
+        }
+
+        bool isUniform() const
+        {
+            return m_storage == nullptr;
+        }
+
+        u32 getUniformValue() const
+        {
+            assert(m_storage == nullptr);
+            return m_idToValue[0];
+        }
+
+        BitStorage* getStorage() const
+        {
+            return m_storage.get();
         }
 
-        BitStorage* getStorage()
+        Snapshot snapshot() const
+        {
+            return {m_idToValue, m_storage};
+        }
+
+        const ref<BitStorage>& getSharedStorage() const
         {
             return m_storage;
         }
 
+        // use an identical storage owned by someone else, it will be cloned
+        // on the next write
+        void shareStorage(const ref<BitStorage>& storage)
+        {
+            assert(m_storage && storage && m_storage->getDataSize() == storage->getDataSize());
+            m_storage = storage;
+        }
+
+        const vector<u32>& getPalette() const
+        {
+            return m_idToValue;
+        }
+
+        // number of entries using each palette id, same order as getPalette()
+        const vector<u32>& getCounts() const
+        {
+            return m_counts;
+        }
+
+        // number of entries holding value
+        u32 getCount(const u32& value) const
+        {
+            u32 count = 0;
+
+            // older saves may list a value more than once
+            for (u32 id = 0; id < m_idToValue.size(); ++id)
+                if (m_idToValue[id] == value)
+                    count += m_counts[id];
+
+            return count;
+        }
+
         u32 getBitExp() const
         {
             return m_bitExp;
         }
 
+        // copy other with its entries reordered, entry i comes from sourceIndex(i)
+        template <typename F>
+        void permuteFrom(const LinearPalette& other, const F& sourceIndex)
+        {
+            m_idToValue = other.m_idToValue;
+            m_counts = other.m_counts;
+            std::copy(std::begin(other.m_valueToId), std::end(other.m_valueToId), std::begin(m_valueToId));
+            m_diffValues = other.m_diffValues;
+            m_bitExp = other.m_bitExp;
+
+            if (!other.m_storage)
+            {
+                m_storage = nullptr;
+                return;
+            }
+
+            m_storage.reset(BitStorage::create<SIZE>(m_bitExp));
+            for (u32 i = 0; i < SIZE; ++i)
+                m_storage->set(i, other.m_storage->get(sourceIndex(i)));
+        }
+
         void fromJBT(const jbt::tag& tag)
         {
             auto& data = tag.get_byte_array("data");
             auto& palette = tag.get_tag("palette");
 
+            // uniform record: no data and a single palette entry
             if (data.data == nullptr)
+            {
+                fill(palette.size() ? palette.get_uint(0) : 0);
                 return;
+            }
+
+            for (u32 value : m_idToValue)
+                m_valueToId[value] = 0;
 
             m_idToValue.clear();
             for (i32 i = 0; i < palette.size(); ++i)
-                m_idToValue.push_back(palette.get_uint(i));
-
-            if (m_storage)
             {
-                delete m_storage;
-                m_storage = nullptr;
+                u32 value = palette.get_uint(i);
+                m_idToValue.push_back(value);
+
+                if (m_valueToId[value] == 0)
+                    m_valueToId[value] = i + 1;
             }
 
             u32 bit = std::round(std::log2(8 * data.size / SIZE));
-            m_storage = BitStorage::create<SIZE>(bit);
+            m_storage.reset(BitStorage::create<SIZE>(bit));
 
             m_storage->fromJBT(data);
             m_diffValues = palette.size();
             m_bitExp = bit;
+
+            m_counts.assign(m_idToValue.size(), 0);
+            m_storage->countValues(m_counts.data());
+        }
+
+        // remove palette entries that are no longer referenced and shrink
+        // storage to the smallest bit width that can hold the rest
+        // return true if the palette or storage has changed
+        bool compact()
+        {
+            if (m_storage == nullptr)
+                return false;
+
+            u32 paletteSize = m_idToValue.size();
+
+            for (u32 value : m_idToValue)
+                m_valueToId[value] = 0;
+
+            // duplicated entries (from older saves) are merged as well
+            vector<u32> remap(paletteSize, 0);
+            vector<u32> idToValue;
+            vector<u32> liveCounts;
+
+            for (u32 id = 0; id < paletteSize; ++id)
+            {
+                if (m_counts[id] == 0)
+                    continue;
+
+                u32 value = m_idToValue[id];
+
+                if (m_valueToId[value] == 0)
+                {
+                    idToValue.push_back(value);
+                    liveCounts.push_back(0);
+                    m_valueToId[value] = idToValue.size();
+                }
+
+                remap[id] = m_valueToId[value] - 1;
+                liveCounts[remap[id]] += m_counts[id];
+            }
+
+            u32 liveValues = idToValue.size();
+            u32 bitExp = GetBitExp(liveValues);
+
+            // only one value left, drop the storage completely
+            if (liveValues == 1)
+            {
+                fill(idToValue[0]);
+                return true;
+            }
+
+            if (liveValues == paletteSize && bitExp == m_bitExp)
+                return false;
+
+            BitStorage* storage = BitStorage::create<SIZE>(bitExp);
+            storage->copyFrom(*m_storage, remap.data());
+
+            m_storage.reset(storage);
+
+            m_idToValue = idToValue;
+            m_counts = liveCounts;
+            m_diffValues = liveValues;
+            m_bitExp = bitExp;
+
+            return true;
+        }
+
+        // widen the storage up front for a caller that knows about how many
+        // values it will write, saving the re-encode at each width boundary
+        void reserve(const u32& valueCount)
+        {
+            u32 bitExp = GetBitExp(valueCount);
+
+            if (m_storage && bitExp <= m_bitExp)
+                return;
+
+            BitStorage* storage = BitStorage::create<SIZE>(bitExp);
+
+            // new storage starts zeroed and id 0 is the uniform value
+            if (m_storage)
+                storage->copyFrom(*m_storage);
+
+            m_storage.reset(storage);
+            m_bitExp = bitExp;
+        }
+
+        u32 getPaletteSize() const
+        {
+            return m_idToValue.size();
         }
 
         jbt::tag toJBT()
@@ -105,24 +306,38 @@ namespace cybrion
         }
 
     private:
+        // smallest exponent such that (1 << exp) bits can hold n different ids
+        static u32 GetBitExp(const u32& n)
+        {
+            return util::ceilLog2(std::max(1u, util::ceilLog2(n)));
+        }
+
+        // storage may be shared with other palettes, clone it before writing
+        void detachStorage()
+        {
+            if (m_storage.use_count() > 1)
+                m_storage.reset(m_storage->clone());
+        }
+
         u32 addValue(const u32& value)
         {
             if (m_storage == nullptr)
             {
-                m_storage = BitStorage::create<SIZE>(0);
+                m_bitExp = 0;
+                m_storage.reset(BitStorage::create<SIZE>(0));
             }
             else if (m_diffValues == m_storage->getMaxValue() + 1)
             {
                 u32 bitExp = util::ceilLog2(util::ceilLog2(m_diffValues)) + 1;
                 auto temp = m_storage;
                 m_bitExp = bitExp;
-                m_storage = BitStorage::create<SIZE>(bitExp);
+                m_storage.reset(BitStorage::create<SIZE>(bitExp));
                 m_storage->copyFrom(*temp);
-                delete temp;
             }
 
             m_diffValues += 1;
             m_idToValue.push_back(value);
+            m_counts.push_back(0);
             m_valueToId[value] = m_diffValues;
 
             return m_diffValues;
@@ -132,6 +347,7 @@ namespace cybrion
         u32 m_diffValues;
         u32 m_valueToId[VALUE_SIZE];
         vector<u32> m_idToValue;
-        BitStorage* m_storage;
+        vector<u32> m_counts;
+        ref<BitStorage> m_storage;
     };
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "core/object_pool.hpp"
+
+namespace cybrion
+{
+    std::mutex poolsLock;
+    vector<ObjectPool *> pools;
+
+    ObjectPool::ObjectPool(const string &name, u32 blockSize, u64 maxPooledBytes) : m_name(name),
+                                                                                   m_blockSize(blockSize),
+                                                                                   m_maxPooled(std::max<u64>(1, maxPooledBytes / blockSize)),
+                                                                                   m_liveCount(0),
+                                                                                   m_pooledCount(0),
+                                                                                   m_heapAllocationCount(0),
+                                                                                   m_reuseCount(0)
+    {
+        std::lock_guard<std::mutex> lock(poolsLock);
+        pools.push_back(this);
+    }
+
+    ObjectPool::~ObjectPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(poolsLock);
+            std::erase(pools, this);
+        }
+
+        for (void *ptr : m_freeList)
+            ::operator delete(ptr);
+    }
+
+    void *ObjectPool::allocate()
+    {
+        m_liveCount += 1;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (!m_freeList.empty())
+            {
+                void *ptr = m_freeList.back();
+                m_freeList.pop_back();
+
+                m_pooledCount -= 1;
+                m_reuseCount += 1;
+
+                return ptr;
+            }
+        }
+
+        m_heapAllocationCount += 1;
+        return ::operator new(m_blockSize);
+    }
+
+    void ObjectPool::deallocate(void *ptr)
+    {
+        if (!ptr)
+            return;
+
+        m_liveCount -= 1;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            if (m_freeList.size() < m_maxPooled)
+            {
+                m_freeList.push_back(ptr);
+                m_pooledCount += 1;
+                return;
+            }
+        }
+
+        ::operator delete(ptr);
+    }
+
+    const string &ObjectPool::getName() const
+    {
+        return m_name;
+    }
+
+    u32 ObjectPool::getBlockSize() const
+    {
+        return m_blockSize;
+    }
+
+    u32 ObjectPool::getLiveCount() const
+    {
+        return m_liveCount;
+    }
+
+    u32 ObjectPool::getPooledCount() const
+    {
+        return m_pooledCount;
+    }
+
+    u64 ObjectPool::getHeapAllocationCount() const
+    {
+        return m_heapAllocationCount;
+    }
+
+    u64 ObjectPool::getReuseCount() const
+    {
+        return m_reuseCount;
+    }
+
+    void EachObjectPool(const std::function<void(ObjectPool &)> &callback)
+    {
+        std::lock_guard<std::mutex> lock(poolsLock);
+        for (auto pool : pools)
+            callback(*pool);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace cybrion
+{
+    // recycles fixed size blocks of one size class instead of going back
+    // to the global heap on every allocation
+    class ObjectPool
+    {
+    public:
+        ObjectPool(const string &name, u32 blockSize, u64 maxPooledBytes);
+        ~ObjectPool();
+
+        void *allocate();
+        void deallocate(void *ptr);
+
+        const string &getName() const;
+        u32 getBlockSize() const;
+        u32 getLiveCount() const;
+        u32 getPooledCount() const;
+        u64 getHeapAllocationCount() const;
+        u64 getReuseCount() const;
+
+    private:
+        string m_name;
+        u32 m_blockSize;
+        u32 m_maxPooled;
+
+        std::mutex m_lock;
+        vector<void *> m_freeList;
+
+        std::atomic<u32> m_liveCount;
+        std::atomic<u32> m_pooledCount;
+        std::atomic<u64> m_heapAllocationCount;
+        std::atomic<u64> m_reuseCount;
+    };
+
+    void EachObjectPool(const std::function<void(ObjectPool &)> &callback);
+}
@@ -1,6 +1,14 @@
 #include "core/pool.hpp"
 
-BS::thread_pool pool(std::thread::hardware_concurrency() - 3);
+#ifdef CYBRION_HEADLESS
+// only the tick thread is kept free
+constexpr unsigned RESERVED_THREADS = 1;
+#else
+// main, render and sound threads
+constexpr unsigned RESERVED_THREADS = 3;
+#endif
+
+BS::thread_pool pool(std::max(1u, std::thread::hardware_concurrency() - std::min(std::thread::hardware_concurrency(), RESERVED_THREADS)));
 
 BS::thread_pool& cybrion::GetPool()
 {
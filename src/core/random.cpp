@@ -0,0 +1,34 @@
+#include "core/random.hpp"
+
+namespace cybrion
+{
+    constexpr u64 GOLDEN_GAMMA = 0x9e3779b97f4a7c15ull;
+
+    RandomStream::RandomStream(i32 seed, const ivec3 &pos, RandomPurpose purpose) : m_counter(0)
+    {
+        m_key = Mix(u64(u32(seed)) + GOLDEN_GAMMA);
+        m_key = Mix(m_key ^ u64(u32(pos.x)));
+        m_key = Mix(m_key ^ (u64(u32(pos.y)) << 32));
+        m_key = Mix(m_key ^ u64(u32(pos.z)));
+        m_key = Mix(m_key ^ (u64(purpose) << 32));
+    }
+
+    u32 RandomStream::operator()()
+    {
+        // the high bits are the better mixed ones
+        return u32(nextU64() >> 32);
+    }
+
+    u64 RandomStream::nextU64()
+    {
+        m_counter += 1;
+        return Mix(m_key + m_counter * GOLDEN_GAMMA);
+    }
+
+    u64 RandomStream::Mix(u64 value)
+    {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+}
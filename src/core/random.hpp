@@ -0,0 +1,35 @@
+#pragma once
+
+namespace cybrion
+{
+    // what a stream is used for, streams of different purposes at the same
+    // position are independent
+    enum class RandomPurpose : u32
+    {
+        DECORATION = 1,
+        TREE = 2
+    };
+
+    // counter based random numbers (SplitMix64), the n-th number only depends
+    // on the key and n, so the same world seed gives the same numbers no
+    // matter which thread draws them or in which order chunks are processed
+    class RandomStream
+    {
+    public:
+        using result_type = u32;
+
+        RandomStream(i32 seed, const ivec3 &pos, RandomPurpose purpose);
+
+        u32 operator()();
+        u64 nextU64();
+
+        static constexpr u32 min() { return 0; }
+        static constexpr u32 max() { return std::numeric_limits<u32>::max(); }
+
+    private:
+        static u64 Mix(u64 value);
+
+        u64 m_key;
+        u64 m_counter;
+    };
+}
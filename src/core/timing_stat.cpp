@@ -0,0 +1,64 @@
+#include "core/timing_stat.hpp"
+
+namespace cybrion
+{
+    TimingStat::TimingStat() : m_total(0), m_count(0), m_last(0), m_max(0)
+    {
+    }
+
+    void TimingStat::add(u32 microseconds)
+    {
+        m_total += microseconds;
+        m_count += 1;
+        m_last = microseconds;
+
+        u32 max = m_max;
+        while (microseconds > max && !m_max.compare_exchange_weak(max, microseconds))
+            ;
+    }
+
+    void TimingStat::reset()
+    {
+        m_total = 0;
+        m_count = 0;
+        m_last = 0;
+        m_max = 0;
+    }
+
+    u32 TimingStat::getCount() const
+    {
+        return m_count;
+    }
+
+    f32 TimingStat::getAverage() const
+    {
+        u32 count = m_count;
+        return count ? m_total / 1000.0f / count : 0;
+    }
+
+    f32 TimingStat::getLast() const
+    {
+        return m_last / 1000.0f;
+    }
+
+    f32 TimingStat::getMax() const
+    {
+        return m_max / 1000.0f;
+    }
+
+    std::mutex statsLock;
+    std::map<string, TimingStat> stats;
+
+    TimingStat &GetTimingStat(const string &name)
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        return stats[name];
+    }
+
+    void EachTimingStat(const std::function<void(const string &, TimingStat &)> &callback)
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        for (auto &[name, stat] : stats)
+            callback(name, stat);
+    }
+}
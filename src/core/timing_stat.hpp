@@ -0,0 +1,29 @@
+#pragma once
+
+namespace cybrion
+{
+    // accumulated timing of a hot path, safe to update from any thread
+    class TimingStat
+    {
+    public:
+        TimingStat();
+
+        void add(u32 microseconds);
+        void reset();
+
+        u32 getCount() const;
+        f32 getAverage() const;
+        f32 getLast() const;
+        f32 getMax() const;
+
+    private:
+        std::atomic<u64> m_total;
+        std::atomic<u32> m_count;
+        std::atomic<u32> m_last;
+        std::atomic<u32> m_max;
+    };
+
+    // named stat shared by the whole program, the reference stays valid
+    TimingStat &GetTimingStat(const string &name);
+    void EachTimingStat(const std::function<void(const string &, TimingStat &)> &callback);
+}
@@ -6,8 +6,11 @@ namespace cybrion
 {
     Game *Game::s_game = nullptr;
     bool Game::s_isFirstGame = true;
+    std::atomic<bool> Game::s_isRunning = false;
 
-    Game::Game(const string &worldPath) : m_worldPath(worldPath), m_isPaused(false)
+    Game::Game(const string &resourcePath, const string &worldPath) : m_resourcePath(resourcePath),
+                                                                      m_worldPath(worldPath),
+                                                                      m_isPaused(false)
     {
         s_game = this;
     }
@@ -22,19 +25,21 @@ namespace cybrion
 
         m_world = World::loadWorld(m_worldPath);
 
-        m_blockLoader.loadTextures();
-        m_blockLoader.loadModels();
+        m_blockLoader.loadTextures(m_resourcePath + "textures/blocks/");
+        m_blockLoader.loadModels(m_resourcePath + "models/blocks/");
 
         if (s_isFirstGame)
         {
             // load block configs
-            m_blockLoader.loadConfigFiles();
+            m_blockLoader.loadConfigFiles(m_resourcePath + "configs/blocks/");
 
             // precompute some block properties
             Blocks::Get().computeRotation();
 
             s_isFirstGame = false;
         }
+
+        s_isRunning = true;
     }
 
     void Game::tick()
@@ -45,6 +50,7 @@ namespace cybrion
 
     void Game::stop()
     {
+        s_isRunning = false;
         m_world->save(m_worldPath);
     }
 
@@ -63,6 +69,11 @@ namespace cybrion
         return *s_game;
     }
 
+    bool Game::IsRunning()
+    {
+        return s_isRunning;
+    }
+
     void Game::pause()
     {
         m_isPaused = true;
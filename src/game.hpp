@@ -6,10 +6,13 @@
 
 namespace cybrion
 {
+    constexpr u32 TICKS_PER_SECOND = 20;
+    constexpr f32 GAME_TICK = 1000000.0f / TICKS_PER_SECOND;
+
     class Game
     {
     public:
-        Game(const string &worldPath);
+        Game(const string &resourcePath, const string &worldPath);
 
         void load();
         void tick();
@@ -31,14 +34,18 @@ namespace cybrion
         virtual void onPlaySound(const string &name) = 0;
 
         static Game &Get();
+        // false before load and once stop begins, world jobs bail out then
+        static bool IsRunning();
 
     protected:
         static Game *s_game;
         static bool s_isFirstGame;
+        static std::atomic<bool> s_isRunning;
 
         BlockLoader m_blockLoader;
         ref<World> m_world;
         Player m_player;
+        string m_resourcePath;
         string m_worldPath;
         bool m_isPaused;
     };
@@ -12,37 +12,46 @@
 #include <filesystem>
 #include <unordered_map>
 #include <unordered_set>
+#include <map>
 #include <iomanip>
 #include <algorithm>
+#include <numeric>
+#include <random>
+#include <bitset>
 #include <array>
 #include <ranges>
 #include <chrono>
 #include <thread>
 #include <mutex>
 #include <limits>
+#include <csignal>
 
 // third-party libraries
-#include <irrKlang.h>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
-#include <glad/glad.h>
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_opengl.h>
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/hash.hpp>
-#include <imgui.h>
-#include <imgui_impl_opengl3.h>
-#include <imgui_impl_sdl2.h>
 #include <yaml-cpp/yaml.h>
-#include <stb_image.h>
-#include <stb_image_resize.h>
 #include <BS_thread_pool.hpp>
 #include <concurrentqueue/concurrentqueue.h>
 #include <FastNoiseLite.h>
 #include <jbt/jbt.hpp>
 #include <jbt/hjbt.hpp>
 
+// window, graphics, ui and sound, not part of the headless build
+#ifndef CYBRION_HEADLESS
+#include <irrKlang.h>
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+#include <imgui.h>
+#include <imgui_impl_opengl3.h>
+#include <imgui_impl_sdl2.h>
+#include <stb_image.h>
+#include <stb_image_resize.h>
+#endif
+
 // common files
 #include "common.hpp"
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "world/entity/entity.hpp"
 #include "voxel_ray.hpp"
 #include "game.hpp"
+#include "core/timing_stat.hpp"
 
 namespace cybrion
 {
@@ -95,13 +96,20 @@ namespace cybrion
         }
 
         // selecting block
+        static auto &raycastStat = GetTimingStat("Block raycast");
+
+        Stopwatch raycastStopwatch;
+        raycastStopwatch.reset();
+
+        BlockAccessor blocks(Game::Get().getWorld());
+
         VoxelRay::Cast(
             m_entity->getPos(),
             m_entity->getDir(),
             0,
             [&](const ivec3& blockPos, const ivec3& normal)
             {
-                Block* block = Game::Get().getWorld().tryGetBlock(blockPos);
+                Block* block = blocks.tryGetBlock(blockPos);
 
                 // stop when block is not loaded
                 if (!block) {
@@ -126,8 +134,15 @@ namespace cybrion
                 m_targetBlock = block;
 
                 return true;
+            },
+            Chunk::LOG_2_BRICK_SIZE,
+            [&](const ivec3& brickPos)
+            {
+                return blocks.isBrickEmpty(brickPos);
             }
         );
+
+        raycastStat.add(raycastStopwatch.getDeltaTime());
     }
 
     Block* Player::getTargetBlock() const
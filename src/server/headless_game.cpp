@@ -0,0 +1,375 @@
+#include "server/headless_game.hpp"
+#include "core/timing_stat.hpp"
+#include "core/pool.hpp"
+#include "world/chunk/chunk_job_scheduler.hpp"
+#include "world/world_pregenerator.hpp"
+
+namespace cybrion
+{
+    namespace
+    {
+        f32 Percentile(vector<u32> &times, f32 fraction)
+        {
+            if (times.empty())
+                return 0;
+
+            u32 index = u32(fraction * (times.size() - 1));
+            std::nth_element(times.begin(), times.begin() + index, times.end());
+            return times[index] / 1000.0f;
+        }
+
+        bool ParsePath(const string &name, ScriptedPath &path)
+        {
+            if (name == "idle")
+                path = ScriptedPath::IDLE;
+            else if (name == "line")
+                path = ScriptedPath::LINE;
+            else if (name == "circle")
+                path = ScriptedPath::CIRCLE;
+            else
+                return false;
+
+            return true;
+        }
+    }
+
+    bool HeadlessOptions::Parse(i32 argc, char *args[], HeadlessOptions &options)
+    {
+        for (i32 i = 1; i < argc; ++i)
+        {
+            string arg = args[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--fast")
+                options.realtime = false;
+            else if (arg == "--no-save")
+                options.save = false;
+            else if (arg == "--world" && hasValue)
+                options.worldName = args[++i];
+            else if (arg == "--ticks" && hasValue)
+                options.ticks = std::stoul(args[++i]);
+            else if (arg == "--path" && hasValue && ParsePath(args[i + 1], options.path))
+                ++i;
+            else if (arg == "--speed" && hasValue)
+                options.speed = std::stof(args[++i]);
+            else if (arg == "--radius" && hasValue)
+                options.radius = std::stof(args[++i]);
+            else if (arg == "--load-distance" && hasValue)
+                options.loadDistance = std::stoi(args[++i]);
+            else if (arg == "--pregen" && hasValue)
+                options.pregenRadius = std::max(0, std::stoi(args[++i]));
+            else if (arg == "--check-determinism" && hasValue)
+                options.checkRadius = std::max(0, std::stoi(args[++i]));
+            else if (arg == "--seed" && hasValue)
+            {
+                options.seed = std::stoi(args[++i]);
+                options.hasSeed = true;
+            }
+            else if (arg == "--report" && hasValue)
+                options.reportInterval = std::max(1ul, std::stoul(args[++i]));
+            else
+            {
+                std::cout << "usage: " << args[0] << " [options]\n"
+                          << "  --world <name>         world in saves/, created when missing (headless)\n"
+                          << "  --ticks <n>            ticks to run, 0 runs forever (1200)\n"
+                          << "  --fast                 do not wait for the tick rate\n"
+                          << "  --no-save              do not save the world on exit\n"
+                          << "  --path <idle|line|circle>  scripted player path (line)\n"
+                          << "  --speed <blocks>       player speed per tick (1)\n"
+                          << "  --radius <blocks>      circle path radius (256)\n"
+                          << "  --load-distance <n>    override the load distance\n"
+                          << "  --report <ticks>       ticks between reports (200)\n"
+                          << "  --pregen <chunks>      generate and save the chunks in a radius around\n"
+                          << "                         the player, then exit, resumes an earlier run\n"
+                          << "  --check-determinism <chunks>  pregenerate new worlds with 1 and all pool\n"
+                          << "                         threads and compare their blocks\n"
+                          << "  --seed <n>             seed of a new world (random)\n";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::atomic<bool> HeadlessGame::s_stopRequested = false;
+
+    HeadlessGame::HeadlessGame(const HeadlessOptions &options) : Game(options.rootPath + "/resources/", options.rootPath + "/saves/" + options.worldName),
+                                                                 m_options(options),
+                                                                 m_tick(0),
+                                                                 m_origin(0),
+                                                                 m_lastReportTick(0),
+                                                                 m_overruns(0),
+                                                                 m_loadedChunks(0),
+                                                                 m_totalLoadedChunks(0),
+                                                                 m_changedChunks(0)
+    {
+    }
+
+    void HeadlessGame::load()
+    {
+        if (!std::filesystem::exists(m_worldPath))
+        {
+            std::filesystem::create_directories(m_options.rootPath + "/saves");
+            if (m_options.hasSeed)
+                World::createNewWorld(m_worldPath, m_options.worldName, m_options.seed);
+            else
+                World::createNewWorld(m_worldPath, m_options.worldName);
+        }
+
+        Game::load();
+
+        WorldSettings settings = WorldSettings::Load(m_options.rootPath + "/settings.jbt");
+
+        if (m_options.loadDistance >= 0)
+        {
+            settings.loadDistance = m_options.loadDistance;
+            settings.unloadDistance = m_options.loadDistance + 2;
+            settings.validate();
+        }
+
+        getWorld().setSettings(settings);
+
+        m_origin = m_player.getEntity()->getPos();
+        m_tickTimes.reserve(m_options.ticks);
+    }
+
+    void HeadlessGame::RequestStop()
+    {
+        s_stopRequested = true;
+    }
+
+    bool HeadlessGame::CheckDeterminism(const HeadlessOptions &options)
+    {
+        HeadlessOptions check = options;
+        check.pregenRadius = options.checkRadius;
+        check.save = true;
+
+        // both worlds need the same seed
+        if (!check.hasSeed)
+        {
+            std::random_device device;
+            check.seed = i32(device());
+            check.hasSeed = true;
+        }
+
+        u32 threadCounts[] = {1, std::max(2u, std::thread::hardware_concurrency())};
+        u64 hashes[2];
+
+        for (u32 i = 0; i < 2; ++i)
+        {
+            check.worldName = options.worldName + "-check-" + std::to_string(threadCounts[i]);
+            std::filesystem::remove_all(check.rootPath + "/saves/" + check.worldName);
+
+            GetPool().reset(threadCounts[i]);
+
+            HeadlessGame game(check);
+            game.load();
+
+            CYBRION_GAME_INFO("Determinism check with {} pool threads, seed {}", threadCounts[i], check.seed);
+            game.run();
+
+            // jobs of the stopped world may still be running
+            GetPool().wait_for_tasks();
+
+            if (s_stopRequested)
+                return false;
+
+            WorldPregenerator pregenerator(game.getWorld(), game.getPlayer().getEntity()->getChunkPos(), check.checkRadius);
+            hashes[i] = pregenerator.hashSavedChunks();
+
+            CYBRION_GAME_INFO("Blocks hash with {} pool threads: {:016x}", threadCounts[i], hashes[i]);
+        }
+
+        if (hashes[0] != hashes[1])
+        {
+            CYBRION_GAME_ERROR("Generation is not deterministic, the worlds are kept in saves/ to compare");
+            return false;
+        }
+
+        CYBRION_GAME_INFO("Generation is deterministic");
+        return true;
+    }
+
+    void HeadlessGame::run()
+    {
+        if (m_options.pregenRadius >= 0)
+            runPregen();
+        else
+            runTicks();
+
+        if (m_options.save)
+        {
+            CYBRION_GAME_INFO("Saving world");
+            stop();
+        }
+    }
+
+    void HeadlessGame::runPregen()
+    {
+        WorldPregenerator pregenerator(getWorld(), m_player.getEntity()->getChunkPos(), m_options.pregenRadius);
+
+        if (!pregenerator.run(s_stopRequested))
+            CYBRION_GAME_INFO("Pregeneration stopped, run it again to continue");
+    }
+
+    void HeadlessGame::runTicks()
+    {
+        Stopwatch stopwatch;
+        Stopwatch tickStopwatch;
+        stopwatch.reset();
+
+        CYBRION_GAME_INFO("Running {} ticks headless ({})", m_options.ticks, m_options.realtime ? "realtime" : "fast");
+
+        while ((m_options.ticks == 0 || m_tick < m_options.ticks) && !s_stopRequested)
+        {
+            if (m_options.realtime)
+            {
+                u32 elapsed = stopwatch.getDeltaTime();
+
+                if (elapsed < GAME_TICK)
+                    std::this_thread::sleep_for(std::chrono::microseconds(u32(GAME_TICK) - elapsed));
+
+                stopwatch.reduceDeltaTime(GAME_TICK);
+            }
+
+            updateScriptedPlayer();
+
+            tickStopwatch.reset();
+            tick();
+            u32 time = tickStopwatch.getDeltaTime();
+
+            // unbounded runs only keep the times of the current report
+            if (m_options.ticks == 0 && m_tickTimes.size() >= m_options.reportInterval)
+                m_tickTimes.clear();
+
+            m_tickTimes.push_back(time);
+            m_overruns += time > GAME_TICK;
+            m_tick += 1;
+
+            static auto &tickStat = GetTimingStat("Game tick");
+            tickStat.add(time);
+
+            if (m_tick - m_lastReportTick >= m_options.reportInterval)
+                report(false);
+        }
+
+        report(true);
+    }
+
+    void HeadlessGame::updateScriptedPlayer()
+    {
+        auto &input = m_player.getInput();
+        f32 t = m_tick * m_options.speed;
+
+        switch (m_options.path)
+        {
+        case ScriptedPath::IDLE:
+            input.isMoving = false;
+            break;
+
+        case ScriptedPath::LINE:
+            input.isMoving = true;
+            input.moveDir = {m_options.speed, 0, 0};
+            break;
+
+        case ScriptedPath::CIRCLE:
+        {
+            // aim at the next point so collisions do not drift the circle
+            f32 angle = (t + m_options.speed) / m_options.radius;
+            vec3 target = m_origin + vec3(std::cos(angle), 0, std::sin(angle)) * m_options.radius - vec3(m_options.radius, 0, 0);
+            vec3 delta = target - m_player.getEntity()->getPos();
+            delta.y = 0;
+
+            f32 length = glm::length(delta);
+            input.isMoving = length > 0;
+
+            if (input.isMoving)
+                input.moveDir = delta / length * std::min(length, m_options.speed * 4);
+            break;
+        }
+        }
+
+        // face the way it moves, the chunk jobs are prioritized by it
+        if (input.isMoving)
+            input.rot = {0, std::atan2(input.moveDir.x, input.moveDir.z), 0};
+    }
+
+    void HeadlessGame::report(bool final)
+    {
+        u32 from = final || m_tickTimes.size() < m_tick - m_lastReportTick ? 0 : m_tickTimes.size() - (m_tick - m_lastReportTick);
+        vector<u32> times(m_tickTimes.begin() + from, m_tickTimes.end());
+
+        u64 total = std::accumulate(times.begin(), times.end(), u64(0));
+        f32 average = times.empty() ? 0 : total / 1000.0f / times.size();
+        f32 max = times.empty() ? 0 : *std::max_element(times.begin(), times.end()) / 1000.0f;
+
+        vec3 pos = m_player.getEntity()->getPos();
+        auto &scheduler = GetChunkJobScheduler();
+
+        CYBRION_GAME_INFO("{} tick {}: {:.3f} ms avg, {:.3f} ms p50, {:.3f} ms p99, {:.3f} ms max, {} over budget",
+                          final ? "Total" : "Tick",
+                          m_tick,
+                          average,
+                          Percentile(times, 0.5f),
+                          Percentile(times, 0.99f),
+                          max,
+                          m_overruns);
+
+        CYBRION_GAME_INFO("Player ({:.0f}, {:.0f}, {:.0f}), {} chunks loaded ({} total, {} changed), {:.2f} MB resident, jobs {}/{}/{}",
+                          pos.x, pos.y, pos.z,
+                          m_loadedChunks,
+                          m_totalLoadedChunks,
+                          m_changedChunks,
+                          getWorld().getResidentMemory() / 1048576.0f,
+                          scheduler.getQueueDepth(ChunkJobStage::GENERATE),
+                          scheduler.getQueueDepth(ChunkJobStage::DECORATE),
+                          scheduler.getQueueDepth(ChunkJobStage::THAW));
+
+        CYBRION_GAME_INFO("Save queue: {} chunks, oldest {:.1f} s, {} unloads deferred",
+                          getWorld().getSaveQueueSize(),
+                          getWorld().getSaveQueueAge() / f32(TICKS_PER_SECOND),
+                          getWorld().getDeferredUnloadCount());
+
+        if (final)
+        {
+            EachTimingStat([](const string &name, TimingStat &stat)
+                           { CYBRION_GAME_INFO("{}: {:.3f} ms avg, {:.3f} ms max ({})", name, stat.getAverage(), stat.getMax(), stat.getCount()); });
+        }
+
+        m_lastReportTick = m_tick;
+    }
+
+    void HeadlessGame::onChunkLoaded(const ref<Chunk> &chunk)
+    {
+        m_loadedChunks += 1;
+        m_totalLoadedChunks += 1;
+    }
+
+    void HeadlessGame::onChunkUnloaded(const ref<Chunk> &chunk)
+    {
+        // chunks still generating were never reported as loaded
+        if (chunk->hasStructure())
+            m_loadedChunks -= 1;
+    }
+
+    void HeadlessGame::onEntitySpawned(const ref<Entity> &entity)
+    {
+    }
+
+    void HeadlessGame::onChunkChanged(const ref<Chunk> &chunk)
+    {
+        m_changedChunks += 1;
+    }
+
+    void HeadlessGame::onBreakBlock(const BlockModifyResult &result)
+    {
+    }
+
+    void HeadlessGame::onPlaceBlock(const BlockModifyResult &result)
+    {
+    }
+
+    void HeadlessGame::onPlaySound(const string &name)
+    {
+    }
+}
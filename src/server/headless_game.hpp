@@ -0,0 +1,100 @@
+#pragma once
+
+#include "game.hpp"
+
+namespace cybrion
+{
+    enum class ScriptedPath
+    {
+        IDLE,
+        LINE,
+        CIRCLE
+    };
+
+    struct HeadlessOptions
+    {
+        string rootPath;
+        string worldName = "headless";
+
+        // 0 runs until the process is stopped
+        u32 ticks = TICKS_PER_SECOND * 60;
+        // false runs ticks back to back to measure throughput
+        bool realtime = true;
+        bool save = true;
+
+        // the simulated player flies along the path, speed in blocks per tick
+        ScriptedPath path = ScriptedPath::LINE;
+        f32 speed = 1.0f;
+        f32 radius = 256.0f;
+
+        // overrides settings.jbt when not negative
+        i32 loadDistance = -1;
+
+        u32 reportInterval = TICKS_PER_SECOND * 10;
+
+        // chunks around spawn generated and saved instead of ticking when
+        // not negative
+        i32 pregenRadius = -1;
+
+        // chunks around spawn pregenerated into fresh worlds with one pool
+        // thread and with all of them, then compared, when not negative
+        i32 checkRadius = -1;
+
+        // seed of new worlds, random unless set
+        bool hasSeed = false;
+        i32 seed = 0;
+
+        // false after printing the usage or an error
+        static bool Parse(i32 argc, char *args[], HeadlessOptions &options);
+    };
+
+    // game without window, graphics or sound, the world is ticked at the
+    // fixed rate against a scripted player and the tick times are reported
+    class HeadlessGame : public Game
+    {
+    public:
+        HeadlessGame(const HeadlessOptions &options);
+
+        void load();
+        void run();
+
+        // the tick loop or pregeneration stops early and the world is saved,
+        // safe to call from a signal handler
+        static void RequestStop();
+
+        // true when both pool sizes saved the same blocks
+        static bool CheckDeterminism(const HeadlessOptions &options);
+
+        void onChunkLoaded(const ref<Chunk> &chunk) override;
+        void onChunkUnloaded(const ref<Chunk> &chunk) override;
+        void onEntitySpawned(const ref<Entity> &entity) override;
+        void onChunkChanged(const ref<Chunk> &chunk) override;
+        void onBreakBlock(const BlockModifyResult &result) override;
+        void onPlaceBlock(const BlockModifyResult &result) override;
+        void onPlaySound(const string &name) override;
+
+    private:
+        void runTicks();
+        void runPregen();
+
+        void updateScriptedPlayer();
+        // tick times since the last report, the whole run when final
+        void report(bool final);
+
+        static std::atomic<bool> s_stopRequested;
+
+        HeadlessOptions m_options;
+
+        u32 m_tick;
+        vec3 m_origin;
+
+        // microseconds per tick for the whole run
+        vector<u32> m_tickTimes;
+        u32 m_lastReportTick;
+        u32 m_overruns;
+
+        u32 m_loadedChunks;
+        u32 m_totalLoadedChunks;
+        u32 m_changedChunks;
+    };
+}
@@ -0,0 +1,37 @@
+#include "server/headless_game.hpp"
+
+using namespace cybrion;
+
+i32 main(i32 argc, char *args[])
+{
+    Blocks::RegisterEnums();
+
+    Log::Init();
+    jbt::init();
+
+    string rootPath{args[0]};
+    std::replace(rootPath.begin(), rootPath.end(), '\\', '/');
+    const size_t last_slash_idx = rootPath.rfind('/');
+    rootPath = rootPath.substr(0, last_slash_idx);
+
+    HeadlessOptions options;
+    options.rootPath = rootPath;
+
+    if (!HeadlessOptions::Parse(argc, args, options))
+        return EXIT_FAILURE;
+
+    // finish the current tile or tick and save instead of dying mid-write
+    std::signal(SIGINT, [](i32)
+                { HeadlessGame::RequestStop(); });
+    std::signal(SIGTERM, [](i32)
+                { HeadlessGame::RequestStop(); });
+
+    if (options.checkRadius >= 0)
+        return HeadlessGame::CheckDeterminism(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    HeadlessGame game(options);
+    game.load();
+    game.run();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace cybrion::util
+{
+    namespace detail
+    {
+        constexpr u32 spreadBits(u32 v)
+        {
+            u32 result = 0;
+            for (u32 i = 0; i < 10; ++i)
+                result |= ((v >> i) & 1) << (3 * i);
+            return result;
+        }
+
+        constexpr auto MORTON_TABLE = []
+        {
+            array<u32, 1024> table{};
+            for (u32 i = 0; i < 1024; ++i)
+                table[i] = spreadBits(i);
+            return table;
+        }();
+
+        constexpr u32 compactBits(u32 v)
+        {
+            v &= 0x09249249;
+            v = (v ^ (v >> 2)) & 0x030c30c3;
+            v = (v ^ (v >> 4)) & 0x0300f00f;
+            v = (v ^ (v >> 8)) & 0xff0000ff;
+            v = (v ^ (v >> 16)) & 0x000003ff;
+            return v;
+        }
+    }
+
+    // interleave the bits of x, y, z (z lowest), each coord must be < 1024
+    inline u32 mortonEncode(u32 x, u32 y, u32 z)
+    {
+#ifdef __BMI2__
+        return _pdep_u32(x, 0x24924924) | _pdep_u32(y, 0x12492492) | _pdep_u32(z, 0x09249249);
+#else
+        return (detail::MORTON_TABLE[x] << 2) | (detail::MORTON_TABLE[y] << 1) | detail::MORTON_TABLE[z];
+#endif
+    }
+
+    inline ivec3 mortonDecode(u32 index)
+    {
+#ifdef __BMI2__
+        return {i32(_pext_u32(index, 0x24924924)), i32(_pext_u32(index, 0x12492492)), i32(_pext_u32(index, 0x09249249))};
+#else
+        return {i32(detail::compactBits(index >> 2)), i32(detail::compactBits(index >> 1)), i32(detail::compactBits(index))};
+#endif
+    }
+}
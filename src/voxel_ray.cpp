@@ -4,6 +4,11 @@
 namespace cybrion
 {
     void VoxelRay::Cast(const vec3& position, const vec3& direction, u32 maxDistance, CastCallback callback)
+    {
+        Cast(position, direction, maxDistance, callback, 0, nullptr);
+    }
+
+    void VoxelRay::Cast(const vec3& position, const vec3& direction, u32 maxDistance, CastCallback callback, i32 logBrickSize, EmptyCallback isEmpty)
     {
         f32 x = floor(position.x);
         f32 y = floor(position.y);
@@ -30,7 +35,26 @@ namespace cybrion
         ivec3 block{ x, y, z };
         ivec3 normal{ 0,0,0 };
 
-        while (!callback(block, normal)) {
+        // only ask once per brick whether it is empty
+        ivec3 brick{ 0, 0, 0 };
+        bool hasBrick = false;
+        bool emptyBrick = false;
+
+        auto inEmptyBrick = [&]() {
+            if (!isEmpty)
+                return false;
+
+            ivec3 current{ block.x >> logBrickSize, block.y >> logBrickSize, block.z >> logBrickSize };
+            if (!hasBrick || current != brick) {
+                brick = current;
+                hasBrick = true;
+                emptyBrick = isEmpty(brick);
+            }
+
+            return emptyBrick;
+        };
+
+        while (inEmptyBrick() || !callback(block, normal)) {
             if (tMaxX < tMaxY) {
                 if (tMaxX < tMaxZ) {
                     if (tMaxX > radius) return;
@@ -9,8 +9,12 @@ namespace cybrion
     public:
 
         using CastCallback = std::function<bool(const ivec3&, const ivec3& normal)>;
+        using EmptyCallback = std::function<bool(const ivec3& brickPos)>;
 
         static void Cast(const vec3& position, const vec3& direction, u32 maxDistance, CastCallback callback);
+
+        // skip the callback for blocks in bricks of size 1 << logBrickSize that isEmpty reports as empty
+        static void Cast(const vec3& position, const vec3& direction, u32 maxDistance, CastCallback callback, i32 logBrickSize, EmptyCallback isEmpty);
         static bool Intersection(const vec3& position, const vec3& direction, const AABB& aabb, ivec3& normal);
     private:
     };
@@ -177,6 +177,9 @@ namespace cybrion
 
         static Blocks &Get();
 
+        // names of the block state enums used by the config files and saves
+        static void RegisterEnums();
+
     private:
         static RockBlock &ROCK;
         static SoilBlock &SOIL;
@@ -6,7 +6,8 @@ namespace cybrion
     void FenceBlock::onTick(const ivec3& pos)
     {
         auto& world = Game::Get().getWorld();
-        world.setBlock(pos, getFenceAt(world, pos));
+        BlockAccessor blocks(world);
+        world.setBlock(pos, getFenceAt(blocks, pos));
     }
 
     bool FenceBlock::isValidNeighbor(Block* block)
@@ -19,29 +20,29 @@ namespace cybrion
         return type == BlockType::FENCE || type == BlockType::FENCE_GATE;
     }
 
-    FenceBlock& FenceBlock::getFenceAt(World& world, const ivec3& pos)
+    FenceBlock& FenceBlock::getFenceAt(BlockAccessor& blocks, const ivec3& pos)
     {
         FenceBlock* block = this;
 
-        Block* eastBlock = world.tryGetBlock({ pos.x + 1, pos.y, pos.z });
+        Block* eastBlock = blocks.tryGetBlock({ pos.x + 1, pos.y, pos.z });
         if (isValidNeighbor(eastBlock))
             block = &block->set<"east">(1);
         else
             block = &block->set<"east">(0);
 
-        Block* westBlock = world.tryGetBlock({ pos.x - 1, pos.y, pos.z });
+        Block* westBlock = blocks.tryGetBlock({ pos.x - 1, pos.y, pos.z });
         if (isValidNeighbor(westBlock))
             block = &block->set<"west">(1);
         else
             block = &block->set<"west">(0);
 
-        Block* northBlock = world.tryGetBlock({ pos.x, pos.y, pos.z + 1 });
+        Block* northBlock = blocks.tryGetBlock({ pos.x, pos.y, pos.z + 1 });
         if (isValidNeighbor(northBlock))
             block = &block->set<"north">(1);
         else
             block = &block->set<"north">(0);
 
-        Block* southBlock = world.tryGetBlock({ pos.x, pos.y, pos.z - 1 });
+        Block* southBlock = blocks.tryGetBlock({ pos.x, pos.y, pos.z - 1 });
         if (isValidNeighbor(southBlock))
             block = &block->set<"south">(1);
         else
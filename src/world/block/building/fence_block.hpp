@@ -4,7 +4,7 @@
 
 namespace cybrion
 {
-    class World;
+    class BlockAccessor;
 
     class FenceBlock : public TBlock <
         FenceBlock,
@@ -19,6 +19,6 @@ namespace cybrion
     public:
         void onTick(const ivec3& pos);
         bool isValidNeighbor(Block* block);
-        FenceBlock& getFenceAt(World& world, const ivec3& pos);
+        FenceBlock& getFenceAt(BlockAccessor& blocks, const ivec3& pos);
     };
 }
\ No newline at end of file
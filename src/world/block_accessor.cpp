@@ -0,0 +1,75 @@
+#include "world/block_accessor.hpp"
+#include "world/world.hpp"
+
+namespace cybrion
+{
+    BlockAccessor::BlockAccessor(World &world) : m_world(world),
+                                                 m_lastPos(std::numeric_limits<i32>::max()),
+                                                 m_last(nullptr),
+                                                 m_center(0),
+                                                 m_found(0),
+                                                 m_chunks{}
+    {
+    }
+
+    Block &BlockAccessor::getBlock(const ivec3 &pos)
+    {
+        Block *block = tryGetBlock(pos);
+        CYBRION_ASSERT(block != nullptr, "Block is invalid or not loaded");
+        return *block;
+    }
+
+    bool BlockAccessor::setBlock(const ivec3 &pos, Block &block)
+    {
+        Chunk *chunk = getChunk(Chunk::posToChunkPos(pos));
+        if (!chunk)
+            return false;
+
+        ivec3 localPos = Chunk::posToLocalPos(pos);
+
+        if (chunk->getBlock(localPos) == block)
+            return false;
+
+        chunk->setBlock(localPos, block);
+        return true;
+    }
+
+    bool BlockAccessor::isBrickEmpty(const ivec3 &brickPos)
+    {
+        constexpr i32 shift = Chunk::LOG_2_CHUNK_SIZE - Chunk::LOG_2_BRICK_SIZE;
+
+        Chunk *chunk = getChunk({brickPos.x >> shift, brickPos.y >> shift, brickPos.z >> shift});
+        if (!chunk)
+            return false;
+
+        return chunk->isBrickEmpty({brickPos.x & (Chunk::BRICKS_PER_AXIS - 1),
+                                    brickPos.y & (Chunk::BRICKS_PER_AXIS - 1),
+                                    brickPos.z & (Chunk::BRICKS_PER_AXIS - 1)});
+    }
+
+    Chunk *BlockAccessor::locate(const ivec3 &chunkPos)
+    {
+        ivec3 d = chunkPos - m_center + 1;
+
+        // left the neighborhood, start a new one around this chunk
+        if (u32(d.x) > 2 || u32(d.y) > 2 || u32(d.z) > 2)
+        {
+            m_center = chunkPos;
+            m_found = 0;
+            d = ivec3(1);
+        }
+
+        u32 slot = (d.x * 3 + d.y) * 3 + d.z;
+
+        if (!(m_found & (1u << slot)))
+        {
+            m_chunks[slot] = m_world.findChunk(chunkPos);
+            m_found |= 1u << slot;
+        }
+
+        m_lastPos = chunkPos;
+        m_last = m_chunks[slot];
+
+        return m_last;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "world/chunk/chunk.hpp"
+
+namespace cybrion
+{
+    class World;
+
+    // reads and writes blocks of a world through a cache of the last chunk
+    // and the 3x3x3 chunks around it, so runs of nearby queries skip the
+    // chunk lookup, only valid while no chunk is unloaded (one tick at most)
+    class BlockAccessor
+    {
+    public:
+        BlockAccessor(World &world);
+
+        Block *tryGetBlock(const ivec3 &pos);
+        Block &getBlock(const ivec3 &pos);
+        // false when the chunk is not loaded or the block is already there
+        bool setBlock(const ivec3 &pos, Block &block);
+        // brick only has air, false when its chunk is not loaded
+        bool isBrickEmpty(const ivec3 &brickPos);
+
+        Chunk *getChunk(const ivec3 &chunkPos);
+
+    private:
+        Chunk *locate(const ivec3 &chunkPos);
+
+        World &m_world;
+
+        ivec3 m_lastPos;
+        Chunk *m_last;
+
+        // neighbors of m_center, a set bit in m_found means the slot is known
+        ivec3 m_center;
+        u32 m_found;
+        array<Chunk *, 27> m_chunks;
+    };
+
+    inline Block *BlockAccessor::tryGetBlock(const ivec3 &pos)
+    {
+        constexpr i32 shift = Chunk::LOG_2_CHUNK_SIZE;
+        constexpr i32 mask = Chunk::CHUNK_SIZE - 1;
+
+        Chunk *chunk = getChunk({pos.x >> shift, pos.y >> shift, pos.z >> shift});
+        if (!chunk)
+            return nullptr;
+
+        return chunk->tryGetBlock({pos.x & mask, pos.y & mask, pos.z & mask});
+    }
+
+    inline Chunk *BlockAccessor::getChunk(const ivec3 &chunkPos)
+    {
+        if (chunkPos == m_lastPos)
+            return m_last;
+
+        return locate(chunkPos);
+    }
+}
@@ -0,0 +1,109 @@
+#include "world/block_edit_session.hpp"
+#include "game.hpp"
+
+namespace cybrion
+{
+    BlockEditSession::BlockEditSession(World &world) : m_world(world),
+                                                       m_blocks(world)
+    {
+    }
+
+    Block *BlockEditSession::tryGetBlock(const ivec3 &pos)
+    {
+        auto it = m_writes.find(pos);
+        if (it != m_writes.end())
+            return m_blocks.getChunk(Chunk::posToChunkPos(pos)) ? it->second : nullptr;
+
+        return m_blocks.tryGetBlock(pos);
+    }
+
+    Block &BlockEditSession::getBlock(const ivec3 &pos)
+    {
+        Block *block = tryGetBlock(pos);
+        CYBRION_ASSERT(block != nullptr, "Block is invalid or not loaded");
+        return *block;
+    }
+
+    void BlockEditSession::setBlock(const ivec3 &pos, Block &block)
+    {
+        m_writes[pos] = &block;
+    }
+
+    bool BlockEditSession::updateBlock(const ivec3 &pos, Block &block)
+    {
+        if (!block.beforePlace(pos))
+            return false;
+
+        m_writes[pos] = &block;
+        m_updates.insert(pos);
+        return true;
+    }
+
+    u32 BlockEditSession::commit()
+    {
+        umap<ivec3, vector<Chunk::BlockWrite>> chunkWrites;
+
+        for (auto &[pos, block] : m_writes)
+            chunkWrites[Chunk::posToChunkPos(pos)].push_back({Chunk::posToLocalPos(pos), block});
+
+        m_writes.clear();
+
+        u32 changed = 0;
+        uset<ivec3> affected;
+
+        for (auto &[chunkPos, writes] : chunkWrites)
+        {
+            Chunk *chunk = m_blocks.getChunk(chunkPos);
+            if (!chunk)
+                continue;
+
+            u32 count = chunk->setBlocks(writes);
+            if (count > 0)
+                affected.insert(chunkPos);
+
+            changed += count;
+        }
+
+        // overlapping neighborhoods are ticked once
+        uset<ivec3> ticked;
+
+        for (auto &pos : m_updates)
+            for (i32 x = -1; x <= 1; ++x)
+                for (i32 y = -1; y <= 1; ++y)
+                    for (i32 z = -1; z <= 1; ++z)
+                        ticked.insert(pos + ivec3(x, y, z));
+
+        m_updates.clear();
+
+        for (auto &pos : ticked)
+        {
+            Block *block = m_blocks.tryGetBlock(pos);
+            if (!block)
+                continue;
+
+            block->onTick(pos);
+            affected.insert(Chunk::posToChunkPos(pos));
+        }
+
+        for (auto &chunkPos : affected)
+        {
+            ref<Chunk> chunk = m_world.getChunk(chunkPos);
+
+            Game::Get().onChunkChanged(chunk);
+            chunk->setDirty(false);
+        }
+
+        return changed;
+    }
+
+    void BlockEditSession::discard()
+    {
+        m_writes.clear();
+        m_updates.clear();
+    }
+
+    u32 BlockEditSession::getWriteCount() const
+    {
+        return m_writes.size();
+    }
+}
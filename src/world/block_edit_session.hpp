@@ -0,0 +1,41 @@
+#pragma once
+
+#include "world/block_accessor.hpp"
+
+namespace cybrion
+{
+    class World;
+
+    // buffers block writes and applies them chunk by chunk on commit, so an
+    // edit touching many blocks updates each chunk in one pass, ticks every
+    // neighbor once and notifies each changed chunk once
+    class BlockEditSession
+    {
+    public:
+        BlockEditSession(World &world);
+
+        // reads see the writes of this session
+        Block *tryGetBlock(const ivec3 &pos);
+        Block &getBlock(const ivec3 &pos);
+
+        // a later write to the same position replaces the earlier one
+        void setBlock(const ivec3 &pos, Block &block);
+        // like World::updateBlock, blocks around pos get onTick on commit
+        bool updateBlock(const ivec3 &pos, Block &block);
+
+        // returns the number of blocks that changed, writes into chunks that
+        // are not loaded are dropped
+        u32 commit();
+        void discard();
+
+        u32 getWriteCount() const;
+
+    private:
+        World &m_world;
+        BlockAccessor m_blocks;
+
+        umap<ivec3, Block *> m_writes;
+        // positions whose neighbors are ticked on commit
+        uset<ivec3> m_updates;
+    };
+}
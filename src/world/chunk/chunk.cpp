@@ -3,19 +3,65 @@
 
 namespace cybrion
 {
+    // saved chunks always use x-major order, whatever the memory layout is
+    static i32 PosToLinearIndex(const ivec3 &pos)
+    {
+        return pos.x * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE + pos.y * Chunk::CHUNK_SIZE + pos.z;
+    }
+
+    static ivec3 LinearIndexToPos(i32 index)
+    {
+        return {index >> (2 * Chunk::LOG_2_CHUNK_SIZE), (index >> Chunk::LOG_2_CHUNK_SIZE) & (Chunk::CHUNK_SIZE - 1), index & (Chunk::CHUNK_SIZE - 1)};
+    }
 
     Chunk::Chunk(const ivec3 &chunkPos) : m_neighbors{nullptr},
+                                          m_readyNeighbors(0),
                                           m_chunkPos(chunkPos),
                                           m_id(0),
                                           m_dirty(true),
                                           m_touched(false),
+                                          m_idleTicks(0),
+                                          m_unusedTicks(0),
+                                          m_accessed(false),
+                                          m_frozen(false),
+                                          m_thawQueued(false),
+                                          m_version(0),
+                                          m_compactPending(false),
                                           m_isNewChunk(true),
                                           m_status(ChunkStatus::NONE),
                                           m_ready(false),
                                           m_unloaded(false),
-                                          m_hasStructure(false)
+                                          m_hasStructure(false),
+                                          m_heightmaps{},
+                                          m_brickNonAir{},
+                                          m_brickNonSolid{},
+                                          m_contents{}
     {
         m_pos = m_chunkPos * Chunk::CHUNK_SIZE + ivec3(Chunk::CHUNK_SIZE / 2, Chunk::CHUNK_SIZE / 2, Chunk::CHUNK_SIZE / 2);
+
+        // a new chunk is full of air
+        m_brickNonSolid.fill(BRICK_VOLUME);
+
+        // nothing was meshed yet
+        m_dirtyBricks.set();
+    }
+
+    void *Chunk::operator new(std::size_t size)
+    {
+        CYBRION_ASSERT(size == sizeof(Chunk), "Chunk pool only allocates chunks");
+        return GetObjectPool().allocate();
+    }
+
+    void Chunk::operator delete(void *ptr)
+    {
+        GetObjectPool().deallocate(ptr);
+    }
+
+    ObjectPool &Chunk::GetObjectPool()
+    {
+        // never destroyed, chunks may still be freed during shutdown
+        static ObjectPool *pool = new ObjectPool("Chunk", sizeof(Chunk), 16 * 1024 * 1024);
+        return *pool;
     }
 
     Block &Chunk::getBlock(const ivec3 &pos) const
@@ -28,6 +74,7 @@ namespace cybrion
     Block *Chunk::tryGetBlock(const ivec3 &pos) const
     {
         CYBRION_ASSERT(0 <= pos.x && pos.x < CHUNK_SIZE && 0 <= pos.y && pos.y < CHUNK_SIZE && 0 <= pos.z && pos.z < CHUNK_SIZE, "Out of chunk size");
+        markAccessed();
         u32 blockId = m_blocks.get(posToIndex(pos));
         return &Blocks::Get().getBlock(blockId);
     }
@@ -54,7 +101,87 @@ namespace cybrion
         CYBRION_ASSERT(0 <= pos.x && pos.x < CHUNK_SIZE && 0 <= pos.y && pos.y < CHUNK_SIZE && 0 <= pos.z && pos.z < CHUNK_SIZE, "Out of chunk size");
         m_dirty = true;
         m_touched = true;
-        m_blocks.set(posToIndex(pos), block.getId());
+        m_compactPending = true;
+        m_idleTicks = 0;
+        markAccessed();
+        m_version += 1;
+
+        i32 index = posToIndex(pos);
+        Block &oldBlock = Blocks::Get().getBlock(m_blocks.get(index));
+        m_blocks.set(index, block.getId());
+
+        updateHeightmaps(pos, block);
+        updateBricks(pos, oldBlock, block);
+        markBlockDirty(pos);
+
+        m_contents.add(oldBlock, -1);
+        m_contents.add(block, 1);
+    }
+
+    u32 Chunk::setBlocks(const vector<BlockWrite> &writes)
+    {
+        markAccessed();
+
+        u32 changed = 0;
+
+        for (auto &[pos, block] : writes)
+        {
+            CYBRION_ASSERT(0 <= pos.x && pos.x < CHUNK_SIZE && 0 <= pos.y && pos.y < CHUNK_SIZE && 0 <= pos.z && pos.z < CHUNK_SIZE, "Out of chunk size");
+
+            i32 index = posToIndex(pos);
+            u32 oldId = m_blocks.get(index);
+
+            if (oldId == block->getId())
+                continue;
+
+            Block &oldBlock = Blocks::Get().getBlock(oldId);
+            m_blocks.set(index, block->getId());
+
+            updateHeightmaps(pos, *block);
+            updateBricks(pos, oldBlock, *block);
+            markBlockDirty(pos);
+
+            m_contents.add(oldBlock, -1);
+            m_contents.add(*block, 1);
+
+            changed += 1;
+        }
+
+        if (changed > 0)
+        {
+            m_dirty = true;
+            m_touched = true;
+            m_compactPending = true;
+            m_idleTicks = 0;
+            m_version += 1;
+        }
+
+        return changed;
+    }
+
+    void Chunk::fill(Block &block)
+    {
+        m_dirty = true;
+        m_dirtyBricks.set();
+        m_touched = true;
+        dropFrozenBlocks();
+        m_version += 1;
+        m_blocks.fill(block.getId());
+
+        for (u32 type = 0; type < HEIGHTMAP_COUNT; ++type)
+            m_heightmaps[type].fill(MatchHeightmap(HeightmapType(type), block) ? CHUNK_SIZE : 0);
+
+        m_brickNonAir.fill(block != Blocks::AIR ? BRICK_VOLUME : 0);
+        m_brickNonSolid.fill(IsSolidBlock(block) ? 0 : BRICK_VOLUME);
+
+        m_contents = {};
+        m_contents.add(block, CHUNK_VOLUME);
+    }
+
+    void Chunk::reserveBlockTypes(u32 count)
+    {
+        thaw();
+        m_blocks.reserve(count);
     }
 
     vec3 Chunk::getPos() const
@@ -84,51 +211,223 @@ namespace cybrion
 
     void Chunk::setNeighbor(const ivec3 &dir, const ref<Chunk> &chunk)
     {
-        m_neighbors[dir.x + 1][dir.y + 1][dir.z + 1] = chunk;
+        auto &neighbor = m_neighbors[dir.x + 1][dir.y + 1][dir.z + 1];
+
+        // the center slot holds the chunk itself
+        if (dir != ivec3(0, 0, 0))
+        {
+            if (!neighbor && chunk)
+                m_readyNeighbors += 1;
+            else if (neighbor && !chunk)
+                m_readyNeighbors -= 1;
+        }
+
+        neighbor = chunk;
     }
 
-    void Chunk::eachNeighbors(const std::function<void(ref<Chunk> &, const ivec3 &)> &callback)
+    bool Chunk::isUniform() const
     {
-        for (i32 x = -1; x <= 1; ++x)
-            for (i32 y = -1; y <= 1; ++y)
-                for (i32 z = -1; z <= 1; ++z)
-                    if (!(x == 0 && y == 0 && z == 0))
-                    {
-                        callback(m_neighbors[x + 1][y + 1][z + 1], ivec3(x, y, z));
-                    }
+        return !m_frozen && m_blocks.isUniform();
     }
 
-    void Chunk::eachBlocks(const std::function<void(Block &, const ivec3 &)> &callback)
+    Block *Chunk::getUniformBlock() const
     {
-        ivec3 pos{0, 0, 0};
-        for (pos.x = 0; pos.x < Chunk::CHUNK_SIZE; ++pos.x)
-            for (pos.y = 0; pos.y < Chunk::CHUNK_SIZE; ++pos.y)
-                for (pos.z = 0; pos.z < Chunk::CHUNK_SIZE; ++pos.z)
-                    callback(getBlock(pos), pos);
+        if (!isUniform())
+            return nullptr;
+
+        return &Blocks::Get().getBlock(m_blocks.getUniformValue());
     }
 
-    void Chunk::eachBlockAndNeighbors(const ivec3 &pos, const std::function<void(Block *&, ref<Chunk> &, const ivec3 &)> &callback)
+    const ChunkContents &Chunk::getContents() const
     {
-        ivec3 dir{0, 0, 0};
-        for (dir.x = -1; dir.x <= 1; ++dir.x)
-            for (dir.y = -1; dir.y <= 1; ++dir.y)
-                for (dir.z = -1; dir.z <= 1; ++dir.z)
+        return m_contents;
+    }
+
+    bool Chunk::hasLiquid() const
+    {
+        return m_contents.hasLiquid();
+    }
+
+    bool Chunk::hasCustomShape() const
+    {
+        return m_contents.hasCustomShape();
+    }
+
+    bool Chunk::isAllOpaque() const
+    {
+        return m_contents.isAllOpaque();
+    }
+
+    u32 Chunk::getBlockCount(Block &block) const
+    {
+        thaw();
+        return m_blocks.getCount(block.getId());
+    }
+
+    Chunk::BlockStorage::Snapshot Chunk::getBlocksSnapshot() const
+    {
+        markAccessed();
+        return m_blocks.snapshot();
+    }
+
+    u32 Chunk::getVersion() const
+    {
+        return m_version;
+    }
+
+    i32 Chunk::getHeight(HeightmapType type, i32 x, i32 z) const
+    {
+        return i32(m_heightmaps[u32(type)][x * CHUNK_SIZE + z]) - 1;
+    }
+
+    const Chunk::Heightmap &Chunk::getHeightmap(HeightmapType type) const
+    {
+        return m_heightmaps[u32(type)];
+    }
+
+    void Chunk::updateHeightmaps(const ivec3 &pos, Block &block)
+    {
+        for (u32 type = 0; type < HEIGHTMAP_COUNT; ++type)
+        {
+            u8 &height = m_heightmaps[type][pos.x * CHUNK_SIZE + pos.z];
+
+            if (MatchHeightmap(HeightmapType(type), block))
+            {
+                height = std::max<u8>(height, pos.y + 1);
+                continue;
+            }
+
+            // top block was removed, find the next one below
+            if (height != pos.y + 1)
+                continue;
+
+            height = 0;
+            for (i32 y = pos.y - 1; y >= 0; --y)
+                if (MatchHeightmap(HeightmapType(type), Blocks::Get().getBlock(m_blocks.get(posToIndex({pos.x, y, pos.z})))))
                 {
-                    auto &&[block, chunk] = tryGetBlockMaybeOutside(pos + dir);
-                    callback(block, chunk, dir);
+                    height = y + 1;
+                    break;
                 }
+        }
+    }
+
+    void Chunk::computeHeightmaps()
+    {
+        thaw();
+
+        for (u32 type = 0; type < HEIGHTMAP_COUNT; ++type)
+            for (i32 x = 0; x < CHUNK_SIZE; ++x)
+                for (i32 z = 0; z < CHUNK_SIZE; ++z)
+                {
+                    u8 &height = m_heightmaps[type][x * CHUNK_SIZE + z];
+
+                    height = 0;
+                    for (i32 y = CHUNK_SIZE - 1; y >= 0; --y)
+                        if (MatchHeightmap(HeightmapType(type), Blocks::Get().getBlock(m_blocks.get(posToIndex({x, y, z})))))
+                        {
+                            height = y + 1;
+                            break;
+                        }
+                }
+    }
+
+    bool Chunk::MatchHeightmap(HeightmapType type, Block &block)
+    {
+        switch (type)
+        {
+        case HeightmapType::MOTION_BLOCKING:
+            return !block.getCollisionBounds().empty() || block.getDisplay() == BlockDisplay::LIQUID;
+        case HeightmapType::OPAQUE:
+            return block.getDisplay() == BlockDisplay::OPAQUE;
+        default:
+            return block != Blocks::AIR;
+        }
+    }
+
+    bool Chunk::isBrickEmpty(const ivec3 &brickPos) const
+    {
+        return m_brickNonAir[brickPosToIndex(brickPos)] == 0;
+    }
+
+    bool Chunk::isBrickSolid(const ivec3 &brickPos) const
+    {
+        return m_brickNonSolid[brickPosToIndex(brickPos)] == 0;
+    }
+
+    const Chunk::BrickCounts &Chunk::getBrickNonAirCounts() const
+    {
+        return m_brickNonAir;
+    }
+
+    const Chunk::BrickCounts &Chunk::getBrickNonSolidCounts() const
+    {
+        return m_brickNonSolid;
+    }
+
+    void Chunk::updateBricks(const ivec3 &pos, Block &oldBlock, Block &block)
+    {
+        i32 brick = brickPosToIndex({pos.x >> LOG_2_BRICK_SIZE, pos.y >> LOG_2_BRICK_SIZE, pos.z >> LOG_2_BRICK_SIZE});
+
+        m_brickNonAir[brick] += (block != Blocks::AIR) - (oldBlock != Blocks::AIR);
+        m_brickNonSolid[brick] += IsSolidBlock(oldBlock) - IsSolidBlock(block);
+    }
+
+    void Chunk::computeBricks()
+    {
+        thaw();
+
+        m_brickNonAir.fill(0);
+        m_brickNonSolid.fill(0);
+
+        for (i32 index = 0; index < CHUNK_VOLUME; ++index)
+        {
+            Block &block = Blocks::Get().getBlock(m_blocks.get(index));
+            ivec3 pos = indexToPos(index);
+            i32 brick = brickPosToIndex({pos.x >> LOG_2_BRICK_SIZE, pos.y >> LOG_2_BRICK_SIZE, pos.z >> LOG_2_BRICK_SIZE});
+
+            m_brickNonAir[brick] += block != Blocks::AIR;
+            m_brickNonSolid[brick] += !IsSolidBlock(block);
+        }
+    }
+
+    void Chunk::computeContents()
+    {
+        thaw();
+
+        // palette counts are kept by the storage, no need to visit every block
+        auto &palette = m_blocks.getPalette();
+        auto &counts = m_blocks.getCounts();
+
+        m_contents = {};
+        for (u32 id = 0; id < palette.size(); ++id)
+            m_contents.add(Blocks::Get().getBlock(palette[id]), counts[id]);
+    }
+
+    bool ChunkContents::hasLiquid() const
+    {
+        return liquid > 0;
+    }
+
+    bool ChunkContents::hasCustomShape() const
+    {
+        return customShape > 0;
     }
 
-    bool Chunk::areAllNeighborsReady()
+    bool ChunkContents::isAllOpaque() const
     {
-        bool result = true;
+        return opaqueCube == Chunk::CHUNK_VOLUME;
+    }
 
-        eachNeighbors([&](ref<Chunk> &chunk, const ivec3 &)
-                      {
-            if (!chunk || !chunk->isReady())
-                result = false; });
+    void ChunkContents::add(Block &block, i32 count)
+    {
+        liquid += block.getDisplay() == BlockDisplay::LIQUID ? count : 0;
+        customShape += block.getShape() == BlockShape::CUSTOM ? count : 0;
+        opaqueCube += Chunk::IsSolidBlock(block) ? count : 0;
+    }
 
-        return result;
+    bool Chunk::areAllNeighborsReady() const
+    {
+        return m_readyNeighbors == 26;
     }
 
     bool Chunk::isNewChunk()
@@ -143,6 +442,12 @@ namespace cybrion
 
     u32 Chunk::getMemorySizeApproximately() const
     {
+        if (m_frozen)
+            return m_frozenBlocks.size();
+
+        if (m_blocks.getStorage() == nullptr)
+            return 0;
+
         return CHUNK_VOLUME * sizeof(u32) / (32 / (1 << m_blocks.getBitExp()));
     }
 
@@ -169,18 +474,188 @@ namespace cybrion
     void Chunk::setDirty(bool dirty)
     {
         m_dirty = dirty;
+
+        if (dirty)
+            m_dirtyBricks.set();
+    }
+
+    void Chunk::markDirty(const ivec3 &min, const ivec3 &max)
+    {
+        ivec3 lo = glm::max(min, ivec3(0));
+        ivec3 hi = glm::min(max, ivec3(CHUNK_SIZE - 1));
+
+        if (lo.x <= hi.x && lo.y <= hi.y && lo.z <= hi.z)
+        {
+            ivec3 brickPos;
+            for (brickPos.x = lo.x >> LOG_2_BRICK_SIZE; brickPos.x <= hi.x >> LOG_2_BRICK_SIZE; ++brickPos.x)
+                for (brickPos.y = lo.y >> LOG_2_BRICK_SIZE; brickPos.y <= hi.y >> LOG_2_BRICK_SIZE; ++brickPos.y)
+                    for (brickPos.z = lo.z >> LOG_2_BRICK_SIZE; brickPos.z <= hi.z >> LOG_2_BRICK_SIZE; ++brickPos.z)
+                        m_dirtyBricks.set(brickPosToIndex(brickPos));
+
+            m_dirty = true;
+        }
+
+        if (isInside(min) && isInside(max))
+            return;
+
+        // the part of the box in each neighbor, moved to its local space
+        ivec3 dir;
+        for (dir.x = -1; dir.x <= 1; ++dir.x)
+            for (dir.y = -1; dir.y <= 1; ++dir.y)
+                for (dir.z = -1; dir.z <= 1; ++dir.z)
+                {
+                    auto &neighbor = m_neighbors[dir.x + 1][dir.y + 1][dir.z + 1];
+
+                    if (dir == ivec3(0, 0, 0) || !neighbor)
+                        continue;
+
+                    ivec3 nmin = glm::max(min - dir * CHUNK_SIZE, ivec3(0));
+                    ivec3 nmax = glm::min(max - dir * CHUNK_SIZE, ivec3(CHUNK_SIZE - 1));
+
+                    if (nmin.x <= nmax.x && nmin.y <= nmax.y && nmin.z <= nmax.z)
+                        neighbor->markDirty(nmin, nmax);
+                }
+    }
+
+    Chunk::BrickMask Chunk::takeDirtyBricks()
+    {
+        BrickMask bricks = m_dirtyBricks;
+        m_dirtyBricks.reset();
+        return bricks;
+    }
+
+    void Chunk::markBlockDirty(const ivec3 &pos)
+    {
+        // nothing to add while generating, every brick is still marked
+        if (m_dirtyBricks.all() && !isInBorder(pos))
+            return;
+
+        ivec3 local = {pos.x & (BRICK_SIZE - 1), pos.y & (BRICK_SIZE - 1), pos.z & (BRICK_SIZE - 1)};
+
+        // a block inside its brick only affects that brick
+        if (local.x != 0 && local.y != 0 && local.z != 0 && local.x != BRICK_SIZE - 1 && local.y != BRICK_SIZE - 1 && local.z != BRICK_SIZE - 1)
+        {
+            m_dirtyBricks.set(brickPosToIndex({pos.x >> LOG_2_BRICK_SIZE, pos.y >> LOG_2_BRICK_SIZE, pos.z >> LOG_2_BRICK_SIZE}));
+            return;
+        }
+
+        markDirty(pos - 1, pos + 1);
+    }
+
+    bool Chunk::compact()
+    {
+        m_compactPending = false;
+        m_idleTicks = 0;
+
+        if (m_frozen)
+            return false;
+
+        return m_blocks.compact();
+    }
+
+    bool Chunk::freeze()
+    {
+        std::lock_guard<std::mutex> lock(m_freezeLock);
+
+        if (m_frozen || m_blocks.getStorage() == nullptr)
+            return false;
+
+        // same codec as region files
+        jbt::omem_stream stream;
+        u32 size = jbt::compression_util::compress_tag(*jbt::serializer::instance, m_blocks.toJBT(), stream);
+        m_frozenBlocks.assign(stream.buffer(), stream.buffer() + size);
+
+        m_frozen = true;
+        m_blocks.reset();
+
+        return true;
+    }
+
+    void Chunk::thaw() const
+    {
+        if (!m_frozen)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_freezeLock);
+
+        if (!m_frozen)
+            return;
+
+        jbt::tag tag;
+        jbt::imem_stream stream(m_frozenBlocks.data(), m_frozenBlocks.size());
+        jbt::compression_util::decompress_tag(*jbt::serializer::instance, stream, tag);
+        m_blocks.fromJBT(tag);
+
+        m_frozenBlocks = {};
+        m_frozen = false;
+    }
+
+    bool Chunk::isFrozen() const
+    {
+        return m_frozen;
+    }
+
+    void Chunk::markAccessed() const
+    {
+        // avoid writing the shared flag on every access
+        if (!m_accessed.load(std::memory_order_relaxed))
+            m_accessed.store(true, std::memory_order_relaxed);
+
+        thaw();
+    }
+
+    void Chunk::dropFrozenBlocks()
+    {
+        std::lock_guard<std::mutex> lock(m_freezeLock);
+        m_frozenBlocks = {};
+        m_frozen = false;
     }
 
     void Chunk::fromJBT(const jbt::tag &tag)
     {
         auto &blocks = tag.get_tag("blocks");
+        dropFrozenBlocks();
+        m_version += 1;
+#ifdef CYBRION_MORTON_CHUNK_LAYOUT
+        BlockStorage linear;
+        linear.fromJBT(blocks);
+        m_blocks.permuteFrom(linear, [](u32 index)
+                             { return PosToLinearIndex(indexToPos(index)); });
+#else
         m_blocks.fromJBT(blocks);
+#endif
+
+        // older records have no heightmaps
+        if (tag.has("heightmaps") && tag.get_byte_array("heightmaps").size == sizeof(m_heightmaps))
+            std::memcpy(m_heightmaps.data(), tag.get_byte_array("heightmaps").data.get(), sizeof(m_heightmaps));
+        else
+            computeHeightmaps();
+
+        computeBricks();
+        computeContents();
     }
 
     jbt::tag Chunk::toJBT()
     {
+        thaw();
+
         jbt::tag tag(jbt::tag_type::OBJECT);
+#ifdef CYBRION_MORTON_CHUNK_LAYOUT
+        BlockStorage linear;
+        linear.permuteFrom(m_blocks, [](u32 index)
+                           { return posToIndex(LinearIndexToPos(index)); });
+        tag.set_tag("blocks", linear.toJBT());
+#else
         tag.set_tag("blocks", m_blocks.toJBT());
+#endif
+
+        jbt::byte_array_t heightmaps{
+            std::shared_ptr<i8>(new i8[sizeof(m_heightmaps)], [](i8 *p)
+                                { delete[] p; }),
+            sizeof(m_heightmaps), false};
+        std::memcpy(heightmaps.data.get(), m_heightmaps.data(), sizeof(m_heightmaps));
+        tag.set_byte_array("heightmaps", heightmaps);
+
         return tag;
     }
 
@@ -190,7 +665,20 @@ namespace cybrion
 
     i32 Chunk::posToIndex(const ivec3 &pos)
     {
-        return pos.x * CHUNK_SIZE * CHUNK_SIZE + pos.y * CHUNK_SIZE + pos.z;
+#ifdef CYBRION_MORTON_CHUNK_LAYOUT
+        return util::mortonEncode(pos.x, pos.y, pos.z);
+#else
+        return PosToLinearIndex(pos);
+#endif
+    }
+
+    ivec3 Chunk::indexToPos(i32 index)
+    {
+#ifdef CYBRION_MORTON_CHUNK_LAYOUT
+        return util::mortonDecode(index);
+#else
+        return LinearIndexToPos(index);
+#endif
     }
 
     ivec3 Chunk::posToLocalPos(const ivec3 &pos)
@@ -207,6 +695,49 @@ namespace cybrion
         return pos.x == 0 || pos.y == 0 || pos.z == 0 || (pos.x == Chunk::CHUNK_SIZE - 1) || (pos.y == Chunk::CHUNK_SIZE - 1) || (pos.z == Chunk::CHUNK_SIZE - 1);
     }
 
+    i32 Chunk::brickPosToIndex(const ivec3 &brickPos)
+    {
+        return (brickPos.x * BRICKS_PER_AXIS + brickPos.y) * BRICKS_PER_AXIS + brickPos.z;
+    }
+
+    ivec3 Chunk::brickIndexToPos(i32 index)
+    {
+        return {index / (BRICKS_PER_AXIS * BRICKS_PER_AXIS), (index / BRICKS_PER_AXIS) % BRICKS_PER_AXIS, index % BRICKS_PER_AXIS};
+    }
+
+    Chunk::BrickMask Chunk::AllBricks()
+    {
+        return BrickMask().set();
+    }
+
+    Chunk::BrickMask Chunk::BorderBricks(const ivec3 &dir)
+    {
+        BrickMask bricks;
+
+        for (i32 index = 0; index < BRICK_COUNT; ++index)
+        {
+            ivec3 brickPos = brickIndexToPos(index);
+            bool border = true;
+
+            for (i32 axis = 0; axis < 3; ++axis)
+            {
+                if (dir[axis] < 0)
+                    border &= brickPos[axis] == 0;
+                else if (dir[axis] > 0)
+                    border &= brickPos[axis] == BRICKS_PER_AXIS - 1;
+            }
+
+            bricks.set(index, border);
+        }
+
+        return bricks;
+    }
+
+    bool Chunk::IsSolidBlock(Block &block)
+    {
+        return block.getDisplay() == BlockDisplay::OPAQUE && block.getShape() == BlockShape::CUBE;
+    }
+
     bool Chunk::isInside(const ivec3 &pos)
     {
         return 0 <= pos.x && pos.x < CHUNK_SIZE && 0 <= pos.y && pos.y < CHUNK_SIZE && 0 <= pos.z && pos.z < CHUNK_SIZE;
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "core/linear_palette.hpp"
+#include "util/morton.hpp"
 #include "world/block/blocks.hpp"
+#include "world/chunk/chunk_job_scheduler.hpp"
+
+#ifndef CYBRION_LOG_2_CHUNK_SIZE
+#define CYBRION_LOG_2_CHUNK_SIZE 5
+#endif
 
 namespace cybrion
 {
@@ -13,35 +19,119 @@ namespace cybrion
         READY
     };
 
+    enum class HeightmapType
+    {
+        MOTION_BLOCKING,
+        OPAQUE,
+        NON_AIR
+    };
+
+    // number of blocks of each kind in a chunk, kept up to date on every
+    // change so content questions don't need a scan
+    struct ChunkContents
+    {
+        u32 liquid = 0;
+        u32 customShape = 0;
+        u32 opaqueCube = 0;
+
+        bool hasLiquid() const;
+        bool hasCustomShape() const;
+        // every block is an opaque cube
+        bool isAllOpaque() const;
+
+        void add(Block &block, i32 count);
+    };
+
     class Chunk
     {
     public:
-        static constexpr i32 LOG_2_CHUNK_SIZE = 5;
+        // set through the CYBRION_LOG_2_CHUNK_SIZE build option
+        static constexpr i32 LOG_2_CHUNK_SIZE = CYBRION_LOG_2_CHUNK_SIZE;
         static constexpr i32 CHUNK_SIZE = 1 << LOG_2_CHUNK_SIZE;
         static constexpr i32 CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+        // chunks are split into bricks that track what they contain
+        static constexpr i32 LOG_2_BRICK_SIZE = 3;
+        static constexpr i32 BRICK_SIZE = 1 << LOG_2_BRICK_SIZE;
+        static constexpr i32 BRICK_VOLUME = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+        static constexpr i32 BRICKS_PER_AXIS = CHUNK_SIZE / BRICK_SIZE;
+        static constexpr i32 BRICK_COUNT = BRICKS_PER_AXIS * BRICKS_PER_AXIS * BRICKS_PER_AXIS;
+        static_assert(LOG_2_CHUNK_SIZE >= LOG_2_BRICK_SIZE + 1 && LOG_2_CHUNK_SIZE <= 6, "chunk size must be 16, 32 or 64");
         static constexpr vec3 CHUNK_ALIGN = vec3(0.5f, 0.5f, 0.5f) - vec3(CHUNK_SIZE / 2, CHUNK_SIZE / 2, CHUNK_SIZE / 2);
 
         using BlockStorage = LinearPalette<Blocks::StateCount(), CHUNK_VOLUME>;
         using Chunk3x3x3 = array<array<array<ref<Chunk>, 3>, 3>, 3>;
+        using BrickCounts = array<u16, BRICK_COUNT>;
+        using BrickMask = std::bitset<BRICK_COUNT>;
+        // per column (x * CHUNK_SIZE + z) topmost y + 1, 0 for empty
+        using Heightmap = array<u8, CHUNK_SIZE * CHUNK_SIZE>;
+
+        // one write of a batch, pos is inside the chunk
+        struct BlockWrite
+        {
+            ivec3 pos;
+            Block *block;
+        };
 
         Chunk(const ivec3 &chunkPos);
 
+        // chunks come and go while moving, recycle them through a pool
+        static void *operator new(std::size_t size);
+        static void operator delete(void *ptr);
+        static ObjectPool &GetObjectPool();
+
         Block &getBlock(const ivec3 &pos) const;
         Block *tryGetBlock(const ivec3 &pos) const;
         tuple<Block *, ref<Chunk>> tryGetBlockMaybeOutside(const ivec3 &pos) const;
         ref<Chunk> getNeighbor(i32 dx, i32 dy, i32 dz) const;
         void setBlock(const ivec3 &pos, Block &block);
+        // apply writes in one pass, the chunk is marked changed once and only
+        // when a block actually changed, returns the number of changed blocks
+        u32 setBlocks(const vector<BlockWrite> &writes);
+        void fill(Block &block);
+        // size block storage for about this many different blocks
+        void reserveBlockTypes(u32 count);
         vec3 getPos() const;
         ivec3 getChunkPos() const;
         void getBlockAndNeighbors(const ivec3 &pos, Block::Block3x3x3 &blocks);
         void getBlockAndNeighborsMaybeOutside(const ivec3 &pos, Block::Block3x3x3 &blocks);
         void setNeighbor(const ivec3 &dir, const ref<Chunk> &chunk);
 
-        void eachNeighbors(const std::function<void(ref<Chunk> &, const ivec3 &)> &callback);
-        void eachBlocks(const std::function<void(Block &, const ivec3 &)> &callback);
-        void eachBlockAndNeighbors(const ivec3 &pos, const std::function<void(Block *&, ref<Chunk> &, const ivec3 &dir)> &callback);
+        // visitors are templates so the callback is inlined into the loop
+        template <typename F>
+        void eachNeighbors(F &&callback);
+        template <typename F>
+        void eachBlocks(F &&callback);
+        // callback(Block *&, ref<Chunk> &, const ivec3 &dir)
+        template <typename F>
+        void eachBlockAndNeighbors(const ivec3 &pos, F &&callback);
+
+        bool isUniform() const;
+        Block *getUniformBlock() const;
+
+        const ChunkContents &getContents() const;
+        bool hasLiquid() const;
+        bool hasCustomShape() const;
+        bool isAllOpaque() const;
+        // number of blocks with this state, without scanning
+        u32 getBlockCount(Block &block) const;
+
+        // consistent view of the blocks for other threads, must be taken on
+        // the thread that modifies the chunk
+        BlockStorage::Snapshot getBlocksSnapshot() const;
+        u32 getVersion() const;
 
-        bool areAllNeighborsReady();
+        // brick only has air / only has opaque cubes, brickPos is inside the chunk
+        bool isBrickEmpty(const ivec3 &brickPos) const;
+        bool isBrickSolid(const ivec3 &brickPos) const;
+        const BrickCounts &getBrickNonAirCounts() const;
+        const BrickCounts &getBrickNonSolidCounts() const;
+
+        // local y of the topmost block of the column matching type, -1 if none
+        i32 getHeight(HeightmapType type, i32 x, i32 z) const;
+        const Heightmap &getHeightmap(HeightmapType type) const;
+
+        // O(1), neighbors are counted as they are linked
+        bool areAllNeighborsReady() const;
         bool isNewChunk();
 
         u32 getId() const;
@@ -53,7 +143,21 @@ namespace cybrion
 
         bool hasStructure() const;
 
+        // true also marks every brick for remeshing
         void setDirty(bool dirty);
+        // mark the bricks whose mesh depends on blocks in the box (local
+        // positions, inclusive), parts of the box outside the chunk are
+        // passed to the linked neighbors
+        void markDirty(const ivec3 &min, const ivec3 &max);
+        // bricks to remesh since the last call, only taken on the main thread
+        BrickMask takeDirtyBricks();
+
+        bool compact();
+
+        // compress block storage of an unused chunk, it is thawed on next access
+        bool freeze();
+        void thaw() const;
+        bool isFrozen() const;
 
         void fromJBT(const jbt::tag &tag);
         jbt::tag toJBT();
@@ -61,15 +165,42 @@ namespace cybrion
         ~Chunk();
 
         static i32 posToIndex(const ivec3 &pos);
+        static ivec3 indexToPos(i32 index);
         static ivec3 posToLocalPos(const ivec3 &pos);
         static ivec3 posToChunkPos(const ivec3 &pos);
         static bool isInBorder(const ivec3 &pos);
         static bool isInside(const ivec3 &pos);
+        static i32 brickPosToIndex(const ivec3 &brickPos);
+        static bool IsSolidBlock(Block &block);
+        static ivec3 brickIndexToPos(i32 index);
+        static BrickMask AllBricks();
+        // bricks against the side, edge or corner of the chunk in direction dir
+        static BrickMask BorderBricks(const ivec3 &dir);
+
+        // number of ticks without modification before a chunk is compacted
+        static constexpr u32 IDLE_TICKS_BEFORE_COMPACT = 200;
+
+        // number of ticks without any access before a chunk may be frozen
+        static constexpr u32 UNUSED_TICKS_BEFORE_FREEZE = 1200;
 
     private:
         friend class World;
         friend class WorldGenerator;
 
+        void markAccessed() const;
+        void dropFrozenBlocks();
+
+        void updateHeightmaps(const ivec3 &pos, Block &block);
+        void computeHeightmaps();
+        static bool MatchHeightmap(HeightmapType type, Block &block);
+
+        void updateBricks(const ivec3 &pos, Block &oldBlock, Block &block);
+        // faces and AO of the blocks around pos depend on it
+        void markBlockDirty(const ivec3 &pos);
+        void computeBricks();
+
+        void computeContents();
+
         static std::atomic<u32> s_idN;
 
         std::atomic<ChunkStatus> m_status;
@@ -78,14 +209,75 @@ namespace cybrion
         std::atomic<bool> m_hasStructure;
         std::atomic<bool> m_dirty;
         std::atomic<bool> m_isNewChunk;
+        std::atomic<bool> m_compactPending;
+        std::atomic<u32> m_idleTicks;
+        std::atomic<bool> m_thawQueued;
+        std::atomic<u32> m_version;
+        mutable std::atomic<bool> m_accessed;
+        mutable std::atomic<bool> m_frozen;
 
         bool m_touched;
+        u32 m_unusedTicks;
+
+        // queued generation, cancelled if the chunk unloads first
+        ref<ChunkJob> m_generateJob;
+        ref<ChunkJob> m_decorateJob;
+
+        // blocks are thawed lazily from const getters
+        mutable BlockStorage m_blocks;
+        mutable vector<char> m_frozenBlocks;
+        mutable std::mutex m_freezeLock;
+
+        static constexpr u32 HEIGHTMAP_COUNT = 3;
+        array<Heightmap, HEIGHTMAP_COUNT> m_heightmaps;
 
-        BlockStorage m_blocks;
+        // per brick number of blocks that are not air / not opaque cubes
+        BrickCounts m_brickNonAir;
+        BrickCounts m_brickNonSolid;
+        BrickMask m_dirtyBricks;
+
+        ChunkContents m_contents;
         Chunk3x3x3 m_neighbors;
+        // linked neighbors, links are only made between ready chunks
+        std::atomic<u32> m_readyNeighbors;
         vec3 m_pos;
         ivec3 m_chunkPos;
 
         u32 m_id;
     };
-}
\ No newline at end of file
+
+    template <typename F>
+    void Chunk::eachNeighbors(F &&callback)
+    {
+        for (i32 x = -1; x <= 1; ++x)
+            for (i32 y = -1; y <= 1; ++y)
+                for (i32 z = -1; z <= 1; ++z)
+                    if (!(x == 0 && y == 0 && z == 0))
+                    {
+                        callback(m_neighbors[x + 1][y + 1][z + 1], ivec3(x, y, z));
+                    }
+    }
+
+    template <typename F>
+    void Chunk::eachBlocks(F &&callback)
+    {
+        markAccessed();
+
+        // walk in storage order so the layout decides the access pattern
+        for (i32 index = 0; index < CHUNK_VOLUME; ++index)
+            callback(Blocks::Get().getBlock(m_blocks.get(index)), indexToPos(index));
+    }
+
+    template <typename F>
+    void Chunk::eachBlockAndNeighbors(const ivec3 &pos, F &&callback)
+    {
+        ivec3 dir{0, 0, 0};
+        for (dir.x = -1; dir.x <= 1; ++dir.x)
+            for (dir.y = -1; dir.y <= 1; ++dir.y)
+                for (dir.z = -1; dir.z <= 1; ++dir.z)
+                {
+                    auto &&[block, chunk] = tryGetBlockMaybeOutside(pos + dir);
+                    callback(block, chunk, dir);
+                }
+    }
+}
@@ -0,0 +1,135 @@
+#include "world/chunk/chunk_grid.hpp"
+
+namespace cybrion
+{
+    ChunkGrid::ChunkGrid() : m_hasCenter(false),
+                             m_center(0),
+                             m_min(0),
+                             m_max(0),
+                             m_slots(SIZE.x * SIZE.y * SIZE.z)
+    {
+    }
+
+    bool ChunkGrid::contains(const ivec3 &pos) const
+    {
+        return pos.x >= m_min.x && pos.x < m_max.x &&
+               pos.y >= m_min.y && pos.y < m_max.y &&
+               pos.z >= m_min.z && pos.z < m_max.z;
+    }
+
+    Chunk *ChunkGrid::find(const ivec3 &pos) const
+    {
+        auto &slot = m_slots[SlotIndex(pos)];
+
+        if (slot.pos != pos)
+            return nullptr;
+
+        return slot.chunk.get();
+    }
+
+    const ref<Chunk> &ChunkGrid::get(const ivec3 &pos) const
+    {
+        static const ref<Chunk> none = nullptr;
+
+        auto &slot = m_slots[SlotIndex(pos)];
+
+        if (slot.pos != pos)
+            return none;
+
+        return slot.chunk;
+    }
+
+    void ChunkGrid::set(const ivec3 &pos, const ref<Chunk> &chunk)
+    {
+        if (!contains(pos))
+            return;
+
+        auto &slot = m_slots[SlotIndex(pos)];
+        slot.pos = pos;
+        slot.chunk = chunk;
+    }
+
+    void ChunkGrid::remove(const ivec3 &pos)
+    {
+        auto &slot = m_slots[SlotIndex(pos)];
+
+        if (slot.pos == pos)
+            slot.chunk = nullptr;
+    }
+
+    void ChunkGrid::recenter(const ivec3 &center, const Lookup &lookup)
+    {
+        if (m_hasCenter && center == m_center)
+            return;
+
+        ivec3 oldMin = m_min;
+        ivec3 oldMax = m_max;
+        ivec3 delta = center - m_center;
+
+        m_center = center;
+        m_min = center - SIZE / 2;
+        m_max = m_min + SIZE;
+
+        if (!m_hasCenter)
+        {
+            m_hasCenter = true;
+            refresh(m_min, m_max, lookup);
+            return;
+        }
+
+        // visit the slab that entered the window along each axis, later axes
+        // only cover what is left so no slot is visited twice, a jump larger
+        // than the window refreshes everything
+        ivec3 lo = m_min;
+        ivec3 hi = m_max;
+
+        for (i32 axis = 0; axis < 3; ++axis)
+        {
+            if (delta[axis] == 0)
+                continue;
+
+            ivec3 a = lo;
+            ivec3 b = hi;
+
+            if (delta[axis] > 0)
+            {
+                a[axis] = std::max(oldMax[axis], m_min[axis]);
+                hi[axis] = a[axis];
+            }
+            else
+            {
+                b[axis] = std::min(oldMin[axis], m_max[axis]);
+                lo[axis] = b[axis];
+            }
+
+            refresh(a, b, lookup);
+        }
+    }
+
+    ivec3 ChunkGrid::getCenter() const
+    {
+        return m_center;
+    }
+
+    u32 ChunkGrid::SlotIndex(const ivec3 &pos)
+    {
+        u32 x = pos.x & (SIZE.x - 1);
+        u32 y = pos.y & (SIZE.y - 1);
+        u32 z = pos.z & (SIZE.z - 1);
+
+        return (x << (LOG_2_HEIGHT + LOG_2_WIDTH)) | (y << LOG_2_WIDTH) | z;
+    }
+
+    void ChunkGrid::refresh(const ivec3 &min, const ivec3 &max, const Lookup &lookup)
+    {
+        ivec3 pos;
+        for (pos.x = min.x; pos.x < max.x; ++pos.x)
+            for (pos.y = min.y; pos.y < max.y; ++pos.y)
+                for (pos.z = min.z; pos.z < max.z; ++pos.z)
+                {
+                    auto &slot = m_slots[SlotIndex(pos)];
+                    slot.pos = pos;
+                    slot.chunk = lookup(pos);
+                }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "world/chunk/chunk.hpp"
+
+namespace cybrion
+{
+    // fixed window of chunk slots around a center, a chunk position maps to
+    // its slot by wrapping each coordinate, so lookups are a few bit ops
+    // and moving the center only touches the slots that enter the window
+    class ChunkGrid
+    {
+    public:
+        using Lookup = std::function<ref<Chunk>(const ivec3 &)>;
+
+        ChunkGrid();
+
+        // true if pos is inside the window, its slot is then authoritative
+        bool contains(const ivec3 &pos) const;
+
+        // chunk at pos, null if pos is outside the window or not loaded
+        Chunk *find(const ivec3 &pos) const;
+        const ref<Chunk> &get(const ivec3 &pos) const;
+
+        // ignored when pos is outside the window
+        void set(const ivec3 &pos, const ref<Chunk> &chunk);
+        void remove(const ivec3 &pos);
+
+        // move the window, slots entering it are filled by lookup
+        void recenter(const ivec3 &center, const Lookup &lookup);
+        ivec3 getCenter() const;
+
+        static constexpr i32 LOG_2_WIDTH = 5;
+        static constexpr i32 LOG_2_HEIGHT = 4;
+        static constexpr ivec3 SIZE = {1 << LOG_2_WIDTH, 1 << LOG_2_HEIGHT, 1 << LOG_2_WIDTH};
+
+    private:
+        struct Slot
+        {
+            ivec3 pos;
+            ref<Chunk> chunk;
+        };
+
+        static u32 SlotIndex(const ivec3 &pos);
+
+        void refresh(const ivec3 &min, const ivec3 &max, const Lookup &lookup);
+
+        bool m_hasCenter;
+        ivec3 m_center;
+        ivec3 m_min;
+        ivec3 m_max;
+        vector<Slot> m_slots;
+    };
+}
@@ -0,0 +1,159 @@
+#include "world/chunk/chunk_job_scheduler.hpp"
+#include "core/pool.hpp"
+
+namespace cybrion
+{
+    ChunkJobScheduler::ChunkJobScheduler() : m_heapDirty(false),
+                                             m_focus(0),
+                                             m_forward(0, 0, -1),
+                                             m_depths{}
+    {
+    }
+
+    ref<ChunkJob> ChunkJobScheduler::submit(ChunkJobStage stage, const ivec3 &chunkPos, std::function<void()> task, bool urgent)
+    {
+        auto job = std::make_shared<ChunkJob>();
+        job->stage = stage;
+        job->chunkPos = chunkPos;
+        job->task = std::move(task);
+        job->urgent = urgent;
+        job->cancelled = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // counted before a worker can see it, or it could go below zero
+            m_depths[u32(stage)] += 1;
+
+            job->priority = computePriority(*job);
+            m_heap.push_back(job);
+
+            if (!m_heapDirty)
+                std::push_heap(m_heap.begin(), m_heap.end(), Compare);
+        }
+
+        // every job gets one pool task, which runs whatever is best by then
+        std::ignore = GetPool().submit([this]
+                                       { runNext(); });
+
+        return job;
+    }
+
+    bool ChunkJobScheduler::cancel(const ref<ChunkJob> &job)
+    {
+        if (!job || job->cancelled.exchange(true))
+            return false;
+
+        m_depths[u32(job->stage)] -= 1;
+
+        // release what the task holds now, the job itself may stay in the
+        // heap for a long time when it is far away
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(task, job->task);
+        }
+
+        return true;
+    }
+
+    void ChunkJobScheduler::promote(const ref<ChunkJob> &job)
+    {
+        if (!job)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (job->urgent)
+            return;
+
+        // the heap is rebuilt once before the next pop
+        job->urgent = true;
+        job->priority = computePriority(*job);
+        m_heapDirty = true;
+    }
+
+    void ChunkJobScheduler::setFocus(const ivec3 &chunkPos, const vec3 &forward)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (chunkPos == m_focus && glm::dot(forward, m_forward) >= REFOCUS_COS)
+            return;
+
+        m_focus = chunkPos;
+        m_forward = forward;
+
+        for (auto &job : m_heap)
+            job->priority = computePriority(*job);
+
+        m_heapDirty = true;
+    }
+
+    u32 ChunkJobScheduler::getQueueDepth(ChunkJobStage stage) const
+    {
+        return m_depths[u32(stage)];
+    }
+
+    void ChunkJobScheduler::runNext()
+    {
+        ref<ChunkJob> job;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_heapDirty)
+            {
+                std::make_heap(m_heap.begin(), m_heap.end(), Compare);
+                m_heapDirty = false;
+            }
+
+            // cancelled jobs are skipped here, their pool tasks find nothing later
+            while (!m_heap.empty())
+            {
+                std::pop_heap(m_heap.begin(), m_heap.end(), Compare);
+                job = std::move(m_heap.back());
+                m_heap.pop_back();
+
+                if (!job->cancelled)
+                    break;
+
+                job = nullptr;
+            }
+        }
+
+        // the flag also marks the job as taken so a late cancel fails
+        if (!job || job->cancelled.exchange(true))
+            return;
+
+        m_depths[u32(job->stage)] -= 1;
+        job->task();
+        job->task = nullptr;
+    }
+
+    f32 ChunkJobScheduler::computePriority(const ChunkJob &job) const
+    {
+        vec3 offset = vec3(job.chunkPos - m_focus);
+        f32 distance = glm::length(offset);
+        f32 priority = distance;
+
+        if (distance > 1 && glm::dot(offset / distance, m_forward) < VIEW_COS)
+            priority += OUT_OF_VIEW_PENALTY;
+
+        if (job.urgent)
+            priority -= URGENT_BONUS;
+
+        return priority;
+    }
+
+    bool ChunkJobScheduler::Compare(const ref<ChunkJob> &a, const ref<ChunkJob> &b)
+    {
+        // max heap on the inverted order keeps the lowest priority on top
+        return a->priority > b->priority;
+    }
+
+    ChunkJobScheduler &GetChunkJobScheduler()
+    {
+        static ChunkJobScheduler scheduler;
+        return scheduler;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace cybrion
+{
+    enum class ChunkJobStage
+    {
+        GENERATE,
+        DECORATE,
+        MESH,
+        THAW
+    };
+
+    struct ChunkJob
+    {
+        ChunkJobStage stage;
+        ivec3 chunkPos;
+        std::function<void()> task;
+
+        // lower runs first, only touched under the scheduler lock
+        f32 priority;
+        bool urgent;
+
+        std::atomic<bool> cancelled;
+    };
+
+    // runs chunk jobs on the thread pool nearest to the player first instead
+    // of in submit order, priorities follow the camera and queued jobs can be
+    // cancelled without waiting for them to reach the front
+    class ChunkJobScheduler
+    {
+    public:
+        ChunkJobScheduler();
+
+        // urgent jobs run before everything that is not urgent
+        ref<ChunkJob> submit(ChunkJobStage stage, const ivec3 &chunkPos, std::function<void()> task, bool urgent = false);
+
+        // the job is dropped when it reaches the front, false if it already ran
+        bool cancel(const ref<ChunkJob> &job);
+
+        // make a queued job urgent, for chunks other chunks are waiting for
+        void promote(const ref<ChunkJob> &job);
+
+        // reprioritize queued jobs when the camera moved far enough
+        void setFocus(const ivec3 &chunkPos, const vec3 &forward);
+
+        u32 getQueueDepth(ChunkJobStage stage) const;
+
+        static constexpr u32 STAGE_COUNT = 4;
+
+        // jobs outside this cone around the camera direction wait longer
+        static constexpr f32 VIEW_COS = 0.5f;
+        static constexpr f32 OUT_OF_VIEW_PENALTY = 4.0f;
+        static constexpr f32 URGENT_BONUS = 1000.0f;
+
+        // refocus only when the camera turned at least this much
+        static constexpr f32 REFOCUS_COS = 0.95f;
+
+    private:
+        void runNext();
+        f32 computePriority(const ChunkJob &job) const;
+
+        static bool Compare(const ref<ChunkJob> &a, const ref<ChunkJob> &b);
+
+        mutable std::mutex m_mutex;
+        vector<ref<ChunkJob>> m_heap;
+        bool m_heapDirty;
+
+        ivec3 m_focus;
+        vec3 m_forward;
+
+        array<std::atomic<u32>, STAGE_COUNT> m_depths;
+    };
+
+    ChunkJobScheduler &GetChunkJobScheduler();
+}
@@ -0,0 +1,145 @@
+#include "world/chunk/chunk_snapshot.hpp"
+
+namespace cybrion
+{
+    ChunkSnapshot::ChunkSnapshot(const Chunk &chunk) : m_version(chunk.getVersion())
+    {
+        ivec3 dir;
+        for (dir.x = -1; dir.x <= 1; ++dir.x)
+            for (dir.y = -1; dir.y <= 1; ++dir.y)
+                for (dir.z = -1; dir.z <= 1; ++dir.z)
+                {
+                    auto &entry = m_chunks[DirToIndex(dir)];
+
+                    // the chunk itself is not linked until it is ready
+                    auto neighbor = dir == ivec3(0, 0, 0) ? nullptr : chunk.getNeighbor(dir.x, dir.y, dir.z);
+                    const Chunk *source = dir == ivec3(0, 0, 0) ? &chunk : neighbor.get();
+
+                    entry.present = source != nullptr;
+                    if (source)
+                    {
+                        entry.blocks = source->getBlocksSnapshot();
+                        entry.brickNonAir = source->getBrickNonAirCounts();
+                        entry.brickNonSolid = source->getBrickNonSolidCounts();
+                        entry.contents = source->getContents();
+                    }
+                }
+    }
+
+    Block &ChunkSnapshot::getBlock(const ivec3 &pos) const
+    {
+        CYBRION_ASSERT(Chunk::isInside(pos), "Out of chunk size");
+        return Blocks::Get().getBlock(m_chunks[CENTER].blocks.get(Chunk::posToIndex(pos)));
+    }
+
+    Block *ChunkSnapshot::tryGetBlockMaybeOutside(const ivec3 &pos) const
+    {
+        auto &entry = m_chunks[DirToIndex(Chunk::posToChunkPos(pos))];
+
+        if (!entry.present)
+            return nullptr;
+
+        return &Blocks::Get().getBlock(entry.blocks.get(Chunk::posToIndex(Chunk::posToLocalPos(pos))));
+    }
+
+    void ChunkSnapshot::getBlockAndNeighbors(const ivec3 &pos, Block::Block3x3x3 &blocks) const
+    {
+        ivec3 dir;
+        for (dir.x = -1; dir.x <= 1; ++dir.x)
+            for (dir.y = -1; dir.y <= 1; ++dir.y)
+                for (dir.z = -1; dir.z <= 1; ++dir.z)
+                    blocks[dir.x + 1][dir.y + 1][dir.z + 1] = &getBlock(pos + dir);
+    }
+
+    void ChunkSnapshot::getBlockAndNeighborsMaybeOutside(const ivec3 &pos, Block::Block3x3x3 &blocks) const
+    {
+        ivec3 dir;
+        for (dir.x = -1; dir.x <= 1; ++dir.x)
+            for (dir.y = -1; dir.y <= 1; ++dir.y)
+                for (dir.z = -1; dir.z <= 1; ++dir.z)
+                    blocks[dir.x + 1][dir.y + 1][dir.z + 1] = tryGetBlockMaybeOutside(pos + dir);
+    }
+
+    bool ChunkSnapshot::isBrickVisible(const ivec3 &brickPos) const
+    {
+        if (m_chunks[CENTER].brickNonAir[Chunk::brickPosToIndex(brickPos)] == 0)
+            return false;
+
+        return !isBrickBuried(brickPos);
+    }
+
+    bool ChunkSnapshot::isBrickBuried(const ivec3 &brickPos) const
+    {
+        if (!isBrickSolid(brickPos))
+            return false;
+
+        for (auto &dir : {ivec3(-1, 0, 0), ivec3(1, 0, 0), ivec3(0, -1, 0), ivec3(0, 1, 0), ivec3(0, 0, -1), ivec3(0, 0, 1)})
+            if (!isBrickSolid(brickPos + dir))
+                return false;
+
+        return true;
+    }
+
+    bool ChunkSnapshot::isBrickSolid(const ivec3 &brickPos) const
+    {
+        ivec3 dir{0, 0, 0};
+        ivec3 local = brickPos;
+
+        for (i32 i = 0; i < 3; ++i)
+        {
+            if (local[i] < 0)
+            {
+                dir[i] = -1;
+                local[i] += Chunk::BRICKS_PER_AXIS;
+            }
+            else if (local[i] >= Chunk::BRICKS_PER_AXIS)
+            {
+                dir[i] = 1;
+                local[i] -= Chunk::BRICKS_PER_AXIS;
+            }
+        }
+
+        auto &entry = m_chunks[DirToIndex(dir)];
+
+        // faces against chunks that are not loaded are culled too
+        if (!entry.present)
+            return true;
+
+        return entry.brickNonSolid[Chunk::brickPosToIndex(local)] == 0;
+    }
+
+    bool ChunkSnapshot::hasNeighbor(const ivec3 &dir) const
+    {
+        return m_chunks[DirToIndex(dir)].present;
+    }
+
+    Block *ChunkSnapshot::getUniformBlock(const ivec3 &dir) const
+    {
+        auto &entry = m_chunks[DirToIndex(dir)];
+
+        if (!entry.present || entry.blocks.storage)
+            return nullptr;
+
+        return &Blocks::Get().getBlock(entry.blocks.idToValue[0]);
+    }
+
+    const ChunkContents *ChunkSnapshot::getContents(const ivec3 &dir) const
+    {
+        auto &entry = m_chunks[DirToIndex(dir)];
+
+        if (!entry.present)
+            return nullptr;
+
+        return &entry.contents;
+    }
+
+    u32 ChunkSnapshot::getVersion() const
+    {
+        return m_version;
+    }
+
+    u32 ChunkSnapshot::DirToIndex(const ivec3 &dir)
+    {
+        return (dir.x + 1) * 9 + (dir.y + 1) * 3 + (dir.z + 1);
+    }
+}
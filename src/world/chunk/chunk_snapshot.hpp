@@ -0,0 +1,94 @@
+#pragma once
+
+#include "world/chunk/chunk.hpp"
+
+namespace cybrion
+{
+    // immutable view of a chunk and its 26 neighbors that worker threads can
+    // read while the chunks keep changing
+    class ChunkSnapshot
+    {
+    public:
+        // take it on the thread that modifies chunks
+        ChunkSnapshot(const Chunk &chunk);
+
+        Block &getBlock(const ivec3 &pos) const;
+        Block *tryGetBlockMaybeOutside(const ivec3 &pos) const;
+        void getBlockAndNeighbors(const ivec3 &pos, Block::Block3x3x3 &blocks) const;
+        void getBlockAndNeighborsMaybeOutside(const ivec3 &pos, Block::Block3x3x3 &blocks) const;
+        template <typename F>
+        void eachBlocks(F &&callback) const;
+
+        // like eachBlocks but skips bricks with only air and solid bricks
+        // that are buried under other solid bricks
+        template <typename F>
+        void eachVisibleBlocks(F &&callback) const;
+
+        // false for bricks eachVisibleBlocks skips
+        bool isBrickVisible(const ivec3 &brickPos) const;
+        template <typename F>
+        void eachBlocksInBrick(const ivec3 &brickPos, F &&callback) const;
+
+        bool hasNeighbor(const ivec3 &dir) const;
+        Block *getUniformBlock(const ivec3 &dir) const;
+        // null when the chunk in that direction is not loaded
+        const ChunkContents *getContents(const ivec3 &dir) const;
+
+        u32 getVersion() const;
+
+    private:
+        struct Entry
+        {
+            bool present;
+            Chunk::BlockStorage::Snapshot blocks;
+            Chunk::BrickCounts brickNonAir;
+            Chunk::BrickCounts brickNonSolid;
+            ChunkContents contents;
+        };
+
+        bool isBrickBuried(const ivec3 &brickPos) const;
+        bool isBrickSolid(const ivec3 &brickPos) const;
+
+        static u32 DirToIndex(const ivec3 &dir);
+
+        static constexpr u32 CENTER = 13;
+
+        array<Entry, 27> m_chunks;
+        u32 m_version;
+    };
+
+    template <typename F>
+    void ChunkSnapshot::eachBlocks(F &&callback) const
+    {
+        auto &blocks = m_chunks[CENTER].blocks;
+
+        for (i32 index = 0; index < Chunk::CHUNK_VOLUME; ++index)
+            callback(Blocks::Get().getBlock(blocks.get(index)), Chunk::indexToPos(index));
+    }
+
+    template <typename F>
+    void ChunkSnapshot::eachVisibleBlocks(F &&callback) const
+    {
+        ivec3 brickPos;
+        for (brickPos.x = 0; brickPos.x < Chunk::BRICKS_PER_AXIS; ++brickPos.x)
+            for (brickPos.y = 0; brickPos.y < Chunk::BRICKS_PER_AXIS; ++brickPos.y)
+                for (brickPos.z = 0; brickPos.z < Chunk::BRICKS_PER_AXIS; ++brickPos.z)
+                {
+                    if (isBrickVisible(brickPos))
+                        eachBlocksInBrick(brickPos, callback);
+                }
+    }
+
+    template <typename F>
+    void ChunkSnapshot::eachBlocksInBrick(const ivec3 &brickPos, F &&callback) const
+    {
+        auto &center = m_chunks[CENTER];
+        ivec3 origin = brickPos * Chunk::BRICK_SIZE;
+
+        ivec3 pos;
+        for (pos.x = origin.x; pos.x < origin.x + Chunk::BRICK_SIZE; ++pos.x)
+            for (pos.y = origin.y; pos.y < origin.y + Chunk::BRICK_SIZE; ++pos.y)
+                for (pos.z = origin.z; pos.z < origin.z + Chunk::BRICK_SIZE; ++pos.z)
+                    callback(Blocks::Get().getBlock(center.blocks.get(Chunk::posToIndex(pos))), pos);
+    }
+}
@@ -0,0 +1,103 @@
+#include "world/chunk/chunk_storage_cache.hpp"
+
+namespace cybrion
+{
+    void ChunkStorageCache::deduplicate(Chunk::BlockStorage &blocks)
+    {
+        const auto &storage = blocks.getSharedStorage();
+
+        if (!storage)
+            return;
+
+        u64 hash = Hash(blocks);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto &entries = m_entries[hash];
+        for (auto &entry : entries)
+        {
+            if (entry.palette != blocks.getPalette())
+                continue;
+
+            // the owner may have written to it since, the data check covers that
+            auto cached = entry.storage.lock();
+
+            if (!cached || cached->getDataSize() != storage->getDataSize())
+                continue;
+
+            if (std::memcmp(cached->getData(), storage->getData(), storage->getDataSize()) != 0)
+                continue;
+
+            blocks.shareStorage(cached);
+            return;
+        }
+
+        entries.push_back({blocks.getPalette(), storage});
+    }
+
+    void ChunkStorageCache::purge()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            auto &entries = it->second;
+
+            std::erase_if(entries, [](const Entry &entry)
+                          { return entry.storage.expired(); });
+
+            if (entries.empty())
+                it = m_entries.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    u32 ChunkStorageCache::getCachedCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        u32 count = 0;
+        for (auto &[hash, entries] : m_entries)
+            count += entries.size();
+
+        return count;
+    }
+
+    u32 ChunkStorageCache::getSharedCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        u32 count = 0;
+        for (auto &[hash, entries] : m_entries)
+            for (auto &entry : entries)
+                if (entry.storage.use_count() > 1)
+                    count += 1;
+
+        return count;
+    }
+
+    u64 ChunkStorageCache::Hash(const Chunk::BlockStorage &blocks)
+    {
+        // fnv-1a over the palette and the packed data
+        u64 hash = 14695981039346656037ull;
+
+        auto mix = [&](u32 v)
+        {
+            hash ^= v;
+            hash *= 1099511628211ull;
+        };
+
+        for (u32 value : blocks.getPalette())
+            mix(value);
+
+        auto storage = blocks.getStorage();
+        const u32 *data = storage->getData();
+        u32 n = storage->getDataSize() / sizeof(u32);
+
+        for (u32 i = 0; i < n; ++i)
+            mix(data[i]);
+
+        return hash;
+    }
+}
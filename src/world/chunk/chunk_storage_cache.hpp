@@ -0,0 +1,36 @@
+#pragma once
+
+#include "world/chunk/chunk.hpp"
+
+namespace cybrion
+{
+    // finds identical block storages so chunks with the same content can
+    // share one, a shared storage is cloned on its next write. Entries don't
+    // keep storages alive, an unshared storage is written in place, so all
+    // calls and chunk writes have to be on the same thread
+    class ChunkStorageCache
+    {
+    public:
+        // replace the storage of blocks with a cached identical one,
+        // or cache it if there is none yet
+        void deduplicate(Chunk::BlockStorage &blocks);
+
+        // drop entries of storages no chunk uses anymore
+        void purge();
+
+        u32 getCachedCount();
+        u32 getSharedCount();
+
+    private:
+        struct Entry
+        {
+            vector<u32> palette;
+            std::weak_ptr<BitStorage> storage;
+        };
+
+        static u64 Hash(const Chunk::BlockStorage &blocks);
+
+        std::mutex m_mutex;
+        umap<u64, vector<Entry>> m_entries;
+    };
+}
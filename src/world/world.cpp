@@ -1,13 +1,48 @@
 #include "world/world.hpp"
 #include "game.hpp"
 #include "core/pool.hpp"
-#include "client/application.hpp"
+#include "core/stopwatch.hpp"
+#include "core/timing_stat.hpp"
 
 namespace cybrion
 {
+    namespace
+    {
+        // x, y, z and block id of every write
+        jbt::tag WritesToJBT(const vector<DecorationWrite> &writes)
+        {
+            jbt::tag tag(jbt::tag_type::LIST);
+
+            for (auto &[pos, block] : writes)
+            {
+                tag.add_int(pos.x);
+                tag.add_int(pos.y);
+                tag.add_int(pos.z);
+                tag.add_int(block->getId());
+            }
+
+            return tag;
+        }
+
+        void WritesFromJBT(const jbt::tag &tag, vector<DecorationWrite> &writes)
+        {
+            for (u32 i = 0; i + 3 < tag.size(); i += 4)
+                writes.push_back({{tag.get_int(i), tag.get_int(i + 1), tag.get_int(i + 2)}, &Blocks::Get().getBlock(tag.get_int(i + 3))});
+        }
+    }
 
-    World::World(const string &name, i32 seed) : m_name(name), m_generator(seed)
+    World::World(const string &name, i32 seed) : m_name(name),
+                                                 m_generator(seed),
+                                                 m_residentMemory(0),
+                                                 m_frozenMemory(0),
+                                                 m_frozenChunkCount(0),
+                                                 m_saveSize(0),
+                                                 m_tick(0),
+                                                 m_saveBackpressure(false),
+                                                 m_hasLoadCenter(false),
+                                                 m_loadCenter(0)
     {
+        buildLoadOffsets();
     }
 
     ref<Entity> World::spawnEntity(const vec3 &pos, const vec3 &rot)
@@ -25,8 +60,10 @@ namespace cybrion
         if (m_chunkMap.find(pos) != m_chunkMap.end())
             return;
 
-        ref<Chunk> chunk = std::make_shared<Chunk>(pos);
+        // not make_shared, it would bypass the chunk pool
+        ref<Chunk> chunk(new Chunk(pos));
         m_chunkMap[pos] = chunk;
+        m_chunkGrid.set(pos, chunk);
 
         ivec3 regionPos = ToRegionPos(pos);
         ivec3 localPos = ToLocalRegionPos(pos);
@@ -34,32 +71,57 @@ namespace cybrion
         loadRegion(regionPos);
 
         auto region = m_regionMap[regionPos];
-        u32 chunkId = localPos.x * 32 * 32 + localPos.y * 32 + localPos.z;
+        u32 chunkId = ToRegionChunkId(localPos);
+
+        // unloaded undecorated and back before its save, the writes are
+        // still here and the terrain is generated again
+        auto unloaded = m_unloadedWrites.find(pos);
+        if (unloaded != m_unloadedWrites.end())
+        {
+            m_pendingWrites[pos] = std::move(unloaded->second);
+            m_unloadedWrites.erase(unloaded);
+        }
 
         if (region->has(chunkId))
         {
             jbt::tag tag;
             region->read(chunkId, tag);
             chunk->fromJBT(tag);
-            chunk->m_isNewChunk = false;
+
+            // saved before its decoration, it is decorated like a generated
+            // chunk and gets the writes its decorated neighbors made
+            if (tag.has("pending_writes"))
+                WritesFromJBT(tag.get_tag("pending_writes"), m_pendingWrites[pos]);
+            else
+            {
+                chunk->m_isNewChunk = false;
+                m_storageCache.deduplicate(chunk->m_blocks);
+            }
+
             m_loadChunkResults.enqueue(chunk);
         }
         else
         {
-            std::ignore = GetPool().submit([this, chunk]
-                                           {
-                if (!Application::Get().isPlayingGame())
+            chunk->m_generateJob = GetChunkJobScheduler().submit(ChunkJobStage::GENERATE, pos, [this, chunk]
+                                                                 {
+                if (!Game::IsRunning())
                     return;   
 
                 if (chunk->isUnloaded())
                     return;
 
+                static auto &generationStat = GetTimingStat("Chunk generation");
+                Stopwatch stopwatch;
+                stopwatch.reset();
+
                 m_generator.generateChunkAt(chunk);
 
+                generationStat.add(stopwatch.getDeltaTime());
+
                 if (chunk->isUnloaded())
                     return;
 
-                if (!Application::Get().isPlayingGame())
+                if (!Game::IsRunning())
                     return;
                 m_loadChunkResults.enqueue(chunk); });
         }
@@ -75,6 +137,11 @@ namespace cybrion
         ref<Chunk> chunk = it->second;
         chunk->m_unloaded = true;
 
+        GetChunkJobScheduler().cancel(chunk->m_generateJob);
+        chunk->m_generateJob = nullptr;
+        GetChunkJobScheduler().cancel(chunk->m_decorateJob);
+        chunk->m_decorateJob = nullptr;
+
         Game::Get().onChunkUnloaded(chunk);
 
         // remove neighbors
@@ -88,22 +155,102 @@ namespace cybrion
         chunk->setNeighbor({0, 0, 0}, nullptr);
 
         m_chunkMap.erase(it);
+        m_chunkGrid.remove(pos);
+
+        // decorated neighbors never decorate again, so the writes they made
+        // into an undecorated chunk are saved with it
+        auto writes = m_pendingWrites.find(pos);
+        if (writes != m_pendingWrites.end())
+        {
+            if (chunk->isReady())
+            {
+                m_unloadedWrites[pos] = std::move(writes->second);
+                m_saveChunkQueue.push({chunk, m_tick});
+            }
+
+            m_pendingWrites.erase(writes);
+        }
 
         if (chunk->hasStructure() && chunk->m_touched)
         {
-            m_saveChunkQueue.push(chunk);
+            m_saveChunkQueue.push({chunk, m_tick});
         }
     }
 
     ref<Chunk> World::getChunk(const ivec3 &pos)
     {
+        if (m_chunkGrid.contains(pos))
+            return m_chunkGrid.get(pos);
+
         auto it = m_chunkMap.find(pos);
         if (it == m_chunkMap.end())
             return nullptr;
         return it->second;
     }
 
+    Chunk *World::findChunk(const ivec3 &pos)
+    {
+        if (m_chunkGrid.contains(pos))
+            return m_chunkGrid.find(pos);
+
+        auto it = m_chunkMap.find(pos);
+        if (it == m_chunkMap.end())
+            return nullptr;
+        return it->second.get();
+    }
+
     void World::tick()
+    {
+        m_tick += 1;
+
+        processChunkResults();
+
+        for (auto &entity : m_entities)
+            entity->setOldPosAndRot();
+
+        for (auto &entity : m_entities)
+            entity->tick();
+
+        updateEntityTransforms();
+
+        auto playerEntity = Game::Get().getPlayer().getEntity();
+        ivec3 ppos = playerEntity->getChunkPos();
+
+        // chunk jobs run nearest the player and in front of it first, the
+        // camera looks the same way horizontally
+        vec3 dir = playerEntity->getDir();
+        vec3 forward = vec3(dir.x, 0, dir.z);
+        f32 length = glm::length(forward);
+        GetChunkJobScheduler().setFocus(ppos, length > 0 ? forward / length : vec3(0, 0, -1));
+
+        m_chunkGrid.recenter(ppos, [this](const ivec3 &pos)
+                             {
+            auto it = m_chunkMap.find(pos);
+            return it == m_chunkMap.end() ? nullptr : it->second; });
+
+        updateLoadFrontier(ppos);
+
+        drainSaveQueue();
+        syncRegionFiles();
+        retryDeferredUnloads(ppos);
+
+        for (auto &[pos, chunk] : m_chunkMap)
+        {
+            if (chunk->m_dirty)
+            {
+                Game::Get().onChunkChanged(chunk);
+                chunk->m_dirty = false;
+            }
+
+            // shrink palette of chunks that have not been modified for a while
+            if (chunk->m_compactPending && chunk->isReady() && ++chunk->m_idleTicks >= Chunk::IDLE_TICKS_BEFORE_COMPACT)
+                chunk->compact();
+        }
+
+        updateFrozenChunks(ppos);
+    }
+
+    void World::processChunkResults()
     {
         ref<Chunk> chunk;
         while (m_loadChunkResults.try_dequeue(chunk))
@@ -112,6 +259,16 @@ namespace cybrion
                 continue;
 
             chunk->m_ready = true;
+            chunk->m_generateJob = nullptr;
+
+            // here and not on the worker, cached storages are written in
+            // place by their owner on this thread
+            if (chunk->isNewChunk())
+                m_storageCache.deduplicate(chunk->m_blocks);
+
+            // a freshly generated or loaded chunk has nothing to compact yet,
+            // loaded chunks with stale entries are compacted on next save
+            chunk->m_compactPending = false;
 
             chunk->m_id = ++chunkId;
             chunk->eachNeighbors([&](ref<Chunk> &, const ivec3 &dir)
@@ -124,80 +281,454 @@ namespace cybrion
                     neighbor->setNeighbor(-dir, chunk);
                 }
 
-                if (neighbor && neighbor->isReady() && neighbor->areAllNeighborsReady() && !neighbor->hasStructure())
-                {
-                    m_generator.generateStructure(neighbor);
-                    Game::Get().onChunkLoaded(neighbor);
-                } });
+                if (neighbor && neighbor->isReady() && neighbor->areAllNeighborsReady())
+                    decorateChunk(neighbor); });
 
             chunk->setNeighbor({0, 0, 0}, chunk);
 
+            // a chunk missing only a few neighbors is close to usable, move
+            // the generation of those neighbors ahead
+            vector<Chunk *> waiting;
+            chunk->eachNeighbors([&](ref<Chunk> &, const ivec3 &dir)
+                                 {
+                Chunk *neighbor = findChunk(chunk->getChunkPos() + dir);
+
+                if (neighbor && !neighbor->isReady() && neighbor->m_generateJob)
+                    waiting.push_back(neighbor); });
+
+            if (waiting.size() <= PROMOTE_WAITING_NEIGHBORS)
+                for (Chunk *neighbor : waiting)
+                    GetChunkJobScheduler().promote(neighbor->m_generateJob);
+
             if (chunk->areAllNeighborsReady())
+                decorateChunk(chunk);
+        }
+
+        DecorationResult result;
+        while (m_decorationResults.try_dequeue(result))
+        {
+            if (result.chunk->isUnloaded())
+                continue;
+
+            result.chunk->m_decorateJob = nullptr;
+            publishDecoration(result.chunk, result.decoration);
+        }
+    }
+
+    void World::decorateChunk(const ref<Chunk> &chunk)
+    {
+        if (chunk->hasStructure() || chunk->m_decorateJob)
+            return;
+
+        // saved chunks were decorated before, uniform chunks have no surface
+        if (!chunk->isNewChunk() || chunk->isUniform())
+        {
+            ChunkDecoration none;
+            publishDecoration(chunk, none);
+            return;
+        }
+
+        // the worker reads a snapshot, the chunk itself stays with this thread
+        auto snapshot = std::make_shared<ChunkSnapshot>(*chunk);
+        Chunk::Heightmap heights = chunk->getHeightmap(HeightmapType::OPAQUE);
+
+        chunk->m_decorateJob = GetChunkJobScheduler().submit(ChunkJobStage::DECORATE, chunk->getChunkPos(), [this, chunk, snapshot, heights]
+                                                             {
+            if (!Game::IsRunning())
+                return;
+
+            if (chunk->isUnloaded())
+                return;
+
+            static auto &decorationStat = GetTimingStat("Chunk decoration");
+            Stopwatch stopwatch;
+            stopwatch.reset();
+
+            auto decoration = m_generator.decorateChunk(*snapshot, heights, chunk->getChunkPos());
+
+            decorationStat.add(stopwatch.getDeltaTime());
+
+            m_decorationResults.enqueue({chunk, std::move(decoration)}); });
+    }
+
+    void World::publishDecoration(const ref<Chunk> &chunk, ChunkDecoration &decoration)
+    {
+        // each touched chunk is updated and remeshed once
+        BlockEditSession edit(*this);
+
+        for (auto &[pos, block] : decoration.own)
+            edit.setBlock(pos, *block);
+
+        // writes of neighbors decorated before this chunk go on top of its own
+        auto it = m_pendingWrites.find(chunk->getChunkPos());
+        if (it != m_pendingWrites.end())
+        {
+            for (auto &[pos, block] : it->second)
+                if (WorldGenerator::CanDecorationReplace(edit.getBlock(pos), *block))
+                    edit.setBlock(pos, *block);
+
+            m_pendingWrites.erase(it);
+        }
+
+        for (auto &[target, writes] : decoration.others)
+        {
+            Chunk *other = findChunk(target);
+
+            // unloaded while this chunk was decorated
+            if (!other)
+                continue;
+
+            if (!other->hasStructure())
             {
-                if (!chunk->m_hasStructure)
-                    m_generator.generateStructure(chunk);
-                Game::Get().onChunkLoaded(chunk);
+                auto &pending = m_pendingWrites[target];
+                pending.insert(pending.end(), writes.begin(), writes.end());
+                continue;
             }
+
+            for (auto &[pos, block] : writes)
+                if (WorldGenerator::CanDecorationReplace(edit.getBlock(pos), *block))
+                    edit.setBlock(pos, *block);
         }
 
-        for (auto &entity : m_entities)
-            entity->setOldPosAndRot();
+        edit.commit();
 
-        for (auto &entity : m_entities)
-            entity->tick();
+        chunk->m_hasStructure = true;
+        Game::Get().onChunkLoaded(chunk);
+    }
 
-        updateEntityTransforms();
+    void World::updateLoadFrontier(const ivec3 &ppos)
+    {
+        // nothing to do until the player enters another chunk
+        if (m_hasLoadCenter && ppos == m_loadCenter)
+            return;
 
-        const i32 d = 8;
+        bool hadCenter = m_hasLoadCenter;
+        ivec3 oldCenter = m_loadCenter;
 
-        ivec3 ppos = Game::Get().getPlayer().getEntity()->getChunkPos();
+        m_hasLoadCenter = true;
+        m_loadCenter = ppos;
 
-        vector<ivec3> loadList;
-        for (i32 x = -d; x < d; ++x)
-            for (i32 y = -2; y <= 6; ++y)
-                for (i32 z = -d; z < d; ++z)
-                    if (x * x + z * z <= d * d)
-                        loadList.push_back({x + ppos.x, y, z + ppos.z});
+        // chunks that entered the load range, the table is ordered by distance
+        for (auto &offset : m_loadOffsets)
+        {
+            ivec3 pos = ppos + offset;
 
-        std::sort(loadList.begin(), loadList.end(), [ppos](ivec3 a, ivec3 b)
-                  { return glm::distance(vec3(a), vec3(ppos)) < glm::distance(vec3(b), vec3(ppos)); });
+            if (hadCenter && isInLoadRange(pos - oldCenter))
+                continue;
 
-        for (auto &pos : loadList)
             loadChunk(pos);
+        }
 
-        vector<ivec3> unloadLists;
-        for (auto &[pos, chunk] : m_chunkMap)
+        vector<ivec3> leaving;
+
+        if (hadCenter)
         {
-            i32 dx = pos.x - ppos.x;
-            i32 dz = pos.z - ppos.z;
-            if (dx * dx + dz * dz > d * d)
-                unloadLists.push_back(pos);
+            // every loaded chunk is inside the old unload range, so only the
+            // part of it that is not inside the new one has to be checked
+            for (auto &offset : m_unloadOffsets)
+            {
+                ivec3 pos = oldCenter + offset;
+
+                if (!isInUnloadRange(pos - ppos) && m_chunkMap.contains(pos))
+                    leaving.push_back(pos);
+            }
         }
+        else
+        {
+            // first tick or the ranges changed
+            for (auto &[pos, chunk] : m_chunkMap)
+                if (!isInUnloadRange(pos - ppos))
+                    leaving.push_back(pos);
+        }
+
+        for (auto &pos : leaving)
+            requestUnload(pos);
+
+        if (!leaving.empty())
+            m_storageCache.purge();
+    }
+
+    bool World::requestUnload(const ivec3 &pos)
+    {
+        // one frontier move can unload hundreds of chunks before the queue
+        // is drained again
+        if (m_saveChunkQueue.size() >= SAVE_QUEUE_HIGH_WATER)
+            m_saveBackpressure = true;
+
+        if (m_saveBackpressure)
+        {
+            Chunk *chunk = findChunk(pos);
+
+            if (chunk && chunk->hasStructure() && chunk->m_touched)
+            {
+                m_deferredUnloads.insert(pos);
+                return false;
+            }
+        }
+
+        unloadChunk(pos);
+        return true;
+    }
+
+    void World::drainSaveQueue()
+    {
+        u32 size = m_saveChunkQueue.size();
+
+        if (size >= SAVE_QUEUE_HIGH_WATER)
+            m_saveBackpressure = true;
+
+        if (size == 0)
+            return;
+
+        // a longer queue gets more time, one chunk is saved in any case
+        u32 budget = std::min(MAX_SAVE_TIME_BUDGET, SAVE_TIME_BUDGET * (1 + size / SAVE_QUEUE_LOW_WATER));
 
-        for (auto &pos : unloadLists)
-            unloadChunk(pos);
+        static auto &saveStat = GetTimingStat("Chunk save");
+        Stopwatch stopwatch;
+        stopwatch.reset();
 
-        const i32 SAVED_CHUNK_PER_TICK = 8;
-        i32 cnt = 0;
-        while (cnt < SAVED_CHUNK_PER_TICK && !m_saveChunkQueue.empty())
+        do
         {
-            auto chunk = m_saveChunkQueue.front();
+            Stopwatch chunkStopwatch;
+            chunkStopwatch.reset();
+
+            auto chunk = m_saveChunkQueue.front().chunk;
             m_saveChunkQueue.pop();
 
             saveChunk(chunk->getChunkPos(), chunk);
-            cnt += 1;
-        }
 
-        syncRegionFiles();
+            saveStat.add(chunkStopwatch.getDeltaTime());
+        } while (!m_saveChunkQueue.empty() && stopwatch.getDeltaTime() < budget);
+
+        if (m_saveChunkQueue.size() <= SAVE_QUEUE_LOW_WATER)
+            m_saveBackpressure = false;
+    }
+
+    void World::retryDeferredUnloads(const ivec3 &ppos)
+    {
+        if (m_saveBackpressure || m_deferredUnloads.empty())
+            return;
+
+        uset<ivec3> deferred;
+        std::swap(deferred, m_deferredUnloads);
+
+        // chunks the player came back to stay loaded, the rest may be
+        // deferred again when they fill the queue past the mark
+        for (auto &pos : deferred)
+            if (m_chunkMap.contains(pos) && !isInUnloadRange(pos - ppos))
+                requestUnload(pos);
+
+        m_storageCache.purge();
+    }
+
+    void World::buildLoadOffsets()
+    {
+        m_loadOffsets.clear();
+        m_unloadOffsets.clear();
+
+        i32 d = m_settings.unloadDistance;
+        i32 h = m_settings.verticalUnloadDistance;
+
+        ivec3 offset;
+        for (offset.x = -d; offset.x <= d; ++offset.x)
+            for (offset.y = -h; offset.y <= h; ++offset.y)
+                for (offset.z = -d; offset.z <= d; ++offset.z)
+                {
+                    if (isInLoadRange(offset))
+                        m_loadOffsets.push_back(offset);
+
+                    if (isInUnloadRange(offset))
+                        m_unloadOffsets.push_back(offset);
+                }
+
+        // spiral outwards from the player
+        std::stable_sort(m_loadOffsets.begin(), m_loadOffsets.end(), [](const ivec3 &a, const ivec3 &b)
+                         { return a.x * a.x + a.y * a.y + a.z * a.z < b.x * b.x + b.y * b.y + b.z * b.z; });
+    }
+
+    bool World::isInLoadRange(const ivec3 &offset) const
+    {
+        i32 d = m_settings.loadDistance;
+        return offset.x * offset.x + offset.z * offset.z <= d * d && std::abs(offset.y) <= m_settings.verticalLoadDistance;
+    }
+
+    bool World::isInUnloadRange(const ivec3 &offset) const
+    {
+        i32 d = m_settings.unloadDistance;
+        return offset.x * offset.x + offset.z * offset.z <= d * d && std::abs(offset.y) <= m_settings.verticalUnloadDistance;
+    }
+
+    void World::updateFrozenChunks(const ivec3 &ppos)
+    {
+        u64 resident = 0;
+        u64 frozen = 0;
+        u32 frozenCount = 0;
+        vector<ref<Chunk>> candidates;
 
         for (auto &[pos, chunk] : m_chunkMap)
         {
-            if (chunk->m_dirty)
+            if (chunk->m_accessed)
             {
-                Game::Get().onChunkChanged(chunk);
-                chunk->m_dirty = false;
+                chunk->m_accessed = false;
+                chunk->m_unusedTicks = 0;
             }
+            else
+                ++chunk->m_unusedTicks;
+
+            if (chunk->isFrozen())
+            {
+                ivec3 d = glm::abs(pos - ppos);
+
+                if (d.x <= THAW_DISTANCE && d.z <= THAW_DISTANCE && !chunk->m_thawQueued.exchange(true))
+                {
+                    GetChunkJobScheduler().submit(ChunkJobStage::THAW, pos, [chunk]
+                                                  {
+                        chunk->thaw();
+                        // counts as used so it isn't the first to freeze again
+                        chunk->markAccessed();
+                        chunk->m_thawQueued = false; });
+                }
+
+                frozen += chunk->getMemorySizeApproximately();
+                frozenCount += 1;
+                continue;
+            }
+
+            resident += chunk->getMemorySizeApproximately();
+
+            // chunks near the player would be thawed again right away
+            ivec3 d = glm::abs(pos - ppos);
+            if (d.x <= THAW_DISTANCE && d.z <= THAW_DISTANCE)
+                continue;
+
+            if (chunk->isReady() && chunk->m_unusedTicks >= Chunk::UNUSED_TICKS_BEFORE_FREEZE)
+                candidates.push_back(chunk);
         }
+
+        u64 residentBudget = u64(m_settings.residentMemoryBudget) * 1048576;
+
+        if (resident > residentBudget)
+        {
+            // least recently used first
+            std::sort(candidates.begin(), candidates.end(), [](const ref<Chunk> &a, const ref<Chunk> &b)
+                      { return a->m_unusedTicks > b->m_unusedTicks; });
+
+            for (auto &chunk : candidates)
+            {
+                if (resident <= residentBudget)
+                    break;
+
+                u32 size = chunk->getMemorySizeApproximately();
+                if (chunk->freeze())
+                {
+                    resident -= size;
+                    frozen += chunk->getMemorySizeApproximately();
+                    frozenCount += 1;
+                }
+            }
+        }
+
+        m_residentMemory = resident;
+        m_frozenMemory = frozen;
+        m_frozenChunkCount = frozenCount;
+
+        if (m_settings.loadedMemoryBudget > 0)
+            unloadOverBudget(ppos, resident + frozen);
+    }
+
+    void World::unloadOverBudget(const ivec3 &ppos, u64 loaded)
+    {
+        u64 budget = u64(m_settings.loadedMemoryBudget) * 1048576;
+
+        if (loaded <= budget)
+            return;
+
+        // only chunks kept by the unload distance can go, anything inside the
+        // load range would not be loaded again until it left it
+        vector<std::pair<i32, ref<Chunk>>> candidates;
+
+        for (auto &[pos, chunk] : m_chunkMap)
+        {
+            ivec3 offset = pos - ppos;
+
+            if (!isInLoadRange(offset))
+                candidates.push_back({offset.x * offset.x + offset.y * offset.y + offset.z * offset.z, chunk});
+        }
+
+        // farthest first
+        std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b)
+                  { return a.first > b.first; });
+
+        bool unloaded = false;
+        for (auto &[distance, chunk] : candidates)
+        {
+            if (loaded <= budget)
+                break;
+
+            u64 size = chunk->getMemorySizeApproximately();
+            if (!requestUnload(chunk->getChunkPos()))
+                continue;
+
+            loaded -= std::min(loaded, size);
+            unloaded = true;
+        }
+
+        if (unloaded)
+            m_storageCache.purge();
+    }
+
+    void World::setSettings(const WorldSettings &settings)
+    {
+        m_settings = settings;
+        m_settings.validate();
+
+        buildLoadOffsets();
+
+        // the next frontier update checks every chunk against the new ranges
+        m_hasLoadCenter = false;
+    }
+
+    const WorldSettings &World::getSettings() const
+    {
+        return m_settings;
+    }
+
+    u64 World::getResidentMemory() const
+    {
+        return m_residentMemory;
+    }
+
+    u64 World::getFrozenMemory() const
+    {
+        return m_frozenMemory;
+    }
+
+    u32 World::getFrozenChunkCount() const
+    {
+        return m_frozenChunkCount;
+    }
+
+    u64 World::getSaveSize() const
+    {
+        return m_saveSize;
+    }
+
+    u32 World::getSaveQueueSize() const
+    {
+        return m_saveChunkQueue.size();
+    }
+
+    u32 World::getSaveQueueAge() const
+    {
+        if (m_saveChunkQueue.empty())
+            return 0;
+
+        return u32(m_tick - m_saveChunkQueue.front().tick);
+    }
+
+    u32 World::getDeferredUnloadCount() const
+    {
+        return m_deferredUnloads.size();
     }
 
     void World::playSound(const string &name)
@@ -217,11 +748,24 @@ namespace cybrion
         ivec3 chunkPos = Chunk::posToChunkPos(pos);
         uvec3 localPos = Chunk::posToLocalPos(pos);
 
-        auto it = m_chunkMap.find(chunkPos);
-        if (it == m_chunkMap.end())
+        Chunk *chunk = findChunk(chunkPos);
+        if (!chunk)
             return nullptr;
 
-        return it->second->tryGetBlock(localPos);
+        return chunk->tryGetBlock(localPos);
+    }
+
+    bool World::isBrickEmpty(const ivec3 &brickPos)
+    {
+        constexpr i32 shift = Chunk::LOG_2_CHUNK_SIZE - Chunk::LOG_2_BRICK_SIZE;
+
+        Chunk *chunk = findChunk({brickPos.x >> shift, brickPos.y >> shift, brickPos.z >> shift});
+        if (!chunk)
+            return false;
+
+        return chunk->isBrickEmpty({brickPos.x & (Chunk::BRICKS_PER_AXIS - 1),
+                                    brickPos.y & (Chunk::BRICKS_PER_AXIS - 1),
+                                    brickPos.z & (Chunk::BRICKS_PER_AXIS - 1)});
     }
 
     BlockModifyResult World::setBlock(const ivec3 &pos, Block &block)
@@ -229,13 +773,11 @@ namespace cybrion
         ivec3 chunkPos = Chunk::posToChunkPos(pos);
         uvec3 localPos = Chunk::posToLocalPos(pos);
 
-        auto it = m_chunkMap.find(chunkPos);
+        auto chunk = getChunk(chunkPos);
 
-        if (it == m_chunkMap.end())
+        if (!chunk)
             return {nullptr, {0, 0, 0}, Blocks::AIR, Blocks::AIR};
 
-        auto chunk = it->second;
-
         Block &oldBlock = chunk->getBlock(localPos);
 
         if (oldBlock == block)
@@ -256,11 +798,9 @@ namespace cybrion
 
         result.chunk->eachBlockAndNeighbors(Chunk::posToLocalPos(result.pos), [&](Block *&neighbor, ref<Chunk> &chunk, const ivec3 &dir)
                                             {
+            // setBlock already marked the bricks of the neighbor chunks
             if (neighbor)
-            {
-                neighbor->onTick(result.pos + dir);
-                chunk->setDirty(true);
-            } });
+                neighbor->onTick(result.pos + dir); });
 
         return result;
     }
@@ -305,6 +845,14 @@ namespace cybrion
     /// TODO: optimize AABB
     void World::updateEntityTransforms()
     {
+        static auto &collisionStat = GetTimingStat("Entity collision");
+
+        Stopwatch stopwatch;
+        stopwatch.reset();
+
+        // the blocks swept by an entity are mostly in one or two chunks
+        BlockAccessor blocks(*this);
+
         for (auto &entity : m_entities)
         {
             AABB bb = entity->getBB();
@@ -326,7 +874,7 @@ namespace cybrion
                     for (i32 y = min.y; y <= max.y; ++y)
                         for (i32 z = min.z; z <= max.z; ++z)
                         {
-                            Block *block = tryGetBlock({x, y, z});
+                            Block *block = blocks.tryGetBlock({x, y, z});
 
                             if (!block)
                                 continue;
@@ -361,16 +909,18 @@ namespace cybrion
             /// FIXME: should be setAABBposition()
             entity->setPos(pos - entity->getLocalBB().getPos());
         }
+
+        collisionStat.add(stopwatch.getDeltaTime());
     }
 
     void World::loadRegion(const ivec3 &pos)
     {
         if (m_regionMap.find(pos) == m_regionMap.end())
         {
-            string regionPath = m_savePath + "/region/" + GetRegionFilename(pos);
+            string regionPath = m_savePath + "/" + GetRegionDirectory() + "/" + GetRegionFilename(pos);
 
             if (!std::filesystem::exists(regionPath))
-                jbt::hjbt_util::create_empty_file(regionPath, 32 * 32 * 32, 1024);
+                jbt::hjbt_util::create_empty_file(regionPath, REGION_VOLUME, 1024);
 
             m_regionMap[pos] = std::make_shared<jbt::hjbt_file>(regionPath);
         }
@@ -407,24 +957,68 @@ namespace cybrion
 
         jbt::save_tag(config, path + "/world.jbt");
 
+        // undecorated chunks with writes of their neighbors are kept too
         for (auto &[pos, chunk] : m_chunkMap)
-            if (chunk->m_touched)
+            if (chunk->m_touched || (chunk->isReady() && m_pendingWrites.contains(pos)))
                 saveChunk(pos, chunk);
 
+        flushSaveQueue();
+        syncRegionFiles();
+        updateSaveSize();
+    }
+
+    void World::flushSaveQueue()
+    {
         while (!m_saveChunkQueue.empty())
         {
-            auto chunk = m_saveChunkQueue.front();
+            auto chunk = m_saveChunkQueue.front().chunk;
             m_saveChunkQueue.pop();
 
             saveChunk(chunk->getChunkPos(), chunk);
         }
 
-        syncRegionFiles();
+        m_saveBackpressure = false;
+    }
+
+    void World::saveChangedChunks()
+    {
+        flushSaveQueue();
+
+        for (auto &[pos, chunk] : m_chunkMap)
+            if (chunk->hasStructure() && chunk->m_touched)
+                saveChunk(pos, chunk);
+    }
+
+    void World::updateSaveSize()
+    {
+        m_saveSize = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(m_savePath + "/" + GetRegionDirectory()))
+            m_saveSize += entry.file_size();
     }
 
     void World::saveChunk(const ivec3 &pos, const ref<Chunk> &chunk)
     {
         // return;
+        jbt::tag writesTag(jbt::tag_type::LIST);
+
+        if (!chunk->hasStructure())
+        {
+            auto unloaded = m_unloadedWrites.find(pos);
+            auto pending = m_pendingWrites.find(pos);
+
+            if (chunk->isUnloaded())
+            {
+                // loaded again before this save, the new chunk has the writes
+                if (unloaded == m_unloadedWrites.end())
+                    return;
+
+                writesTag = WritesToJBT(unloaded->second);
+                m_unloadedWrites.erase(unloaded);
+            }
+            else if (pending != m_pendingWrites.end())
+                writesTag = WritesToJBT(pending->second);
+        }
+
         ivec3 regionPos = ToRegionPos(pos);
         ivec3 localPos = ToLocalRegionPos(pos);
 
@@ -435,8 +1029,78 @@ namespace cybrion
         if (!region->is_writing)
             region->begin_write();
 
+        // drop unused palette entries before they are written to disk
+        chunk->compact();
+
         auto tag = chunk->toJBT();
-        region->write(localPos.x * 32 * 32 + localPos.y * 32 + localPos.z, tag);
+
+        // marks the record as not decorated yet, even without writes
+        if (!chunk->hasStructure())
+            tag.set_tag("pending_writes", writesTag);
+
+        region->write(ToRegionChunkId(localPos), tag);
+
+        // unloading only saves it again if it changes after this
+        chunk->m_touched = false;
+    }
+
+    bool World::isChunkSaved(const ivec3 &pos)
+    {
+        ivec3 regionPos = ToRegionPos(pos);
+
+        // a missing file is not created just to be asked
+        if (!m_regionMap.contains(regionPos) && !std::filesystem::exists(m_savePath + "/" + GetRegionDirectory() + "/" + GetRegionFilename(regionPos)))
+            return false;
+
+        loadRegion(regionPos);
+
+        auto region = m_regionMap[regionPos];
+        u32 chunkId = ToRegionChunkId(ToLocalRegionPos(pos));
+
+        if (!region->has(chunkId))
+            return false;
+
+        // records of chunks unloaded before their decoration are not done,
+        // telling them apart needs the record itself
+        jbt::tag tag;
+        region->read(chunkId, tag);
+
+        return !tag.has("pending_writes");
+    }
+
+    bool World::readSavedChunk(const ivec3 &pos, Chunk &chunk)
+    {
+        if (!isChunkSaved(pos))
+            return false;
+
+        jbt::tag tag;
+        m_regionMap[ToRegionPos(pos)]->read(ToRegionChunkId(ToLocalRegionPos(pos)), tag);
+        chunk.fromJBT(tag);
+
+        return true;
+    }
+
+    void World::closeUnusedRegions()
+    {
+        flushSaveQueue();
+        syncRegionFiles();
+
+        uset<ivec3> used;
+        for (auto &[pos, chunk] : m_chunkMap)
+            used.insert(ToRegionPos(pos));
+
+        for (auto it = m_regionMap.begin(); it != m_regionMap.end();)
+        {
+            if (used.contains(it->first))
+            {
+                ++it;
+                continue;
+            }
+
+            // the destructor leaves the stream open
+            it->second->close();
+            it = m_regionMap.erase(it);
+        }
     }
 
     void World::syncRegionFiles()
@@ -446,14 +1110,18 @@ namespace cybrion
                 region->end_write();
     }
 
-    void World::createNewWorld(const string &name)
+    void World::createNewWorld(const string &worldPath, const string &name)
+    {
+        std::random_device device;
+        createNewWorld(worldPath, name, i32(device()));
+    }
+
+    void World::createNewWorld(const string &worldPath, const string &name, i32 seed)
     {
         jbt::tag config(jbt::tag_type::OBJECT);
 
         config.set_string("name", name);
-
-        std::srand((unsigned)std::time(NULL));
-        config.set_int("seed", std::rand());
+        config.set_int("seed", seed);
 
         config.set_float("player_x", 0);
         config.set_float("player_y", 60);
@@ -471,13 +1139,11 @@ namespace cybrion
 
         config.set_tag("player_inventory", inventoryTag);
 
-        string worldPath = Application::Get().getSavePath(name);
-
         // create world folder
         std::filesystem::create_directory(worldPath);
         jbt::save_tag(config, worldPath + "/world.jbt");
 
-        std::filesystem::create_directory(worldPath + "/region");
+        std::filesystem::create_directory(worldPath + "/" + GetRegionDirectory());
 
         CYBRION_GAME_INFO("Created world {} with seed {}", name, config.get_int("seed"));
     }
@@ -490,6 +1156,9 @@ namespace cybrion
         auto world = std::make_shared<World>(config.get_string("name"), config.get_int("seed"));
         world->m_savePath = path;
 
+        // worlds saved with another chunk size have no region folder for this one
+        std::filesystem::create_directory(path + "/" + GetRegionDirectory());
+
         auto &player = Game::Get().getPlayer();
 
         // spawn player
@@ -518,14 +1187,26 @@ namespace cybrion
 
     ivec3 World::ToRegionPos(const ivec3 &pos)
     {
-        return {pos.x >> 5, pos.y >> 5, pos.z >> 5};
+        return {pos.x >> LOG_2_REGION_SIZE, pos.y >> LOG_2_REGION_SIZE, pos.z >> LOG_2_REGION_SIZE};
     }
     ivec3 World::ToLocalRegionPos(const ivec3 &pos)
     {
-        return {pos.x & 31, pos.y & 31, pos.z & 31};
+        return {pos.x & (REGION_SIZE - 1), pos.y & (REGION_SIZE - 1), pos.z & (REGION_SIZE - 1)};
+    }
+    u32 World::ToRegionChunkId(const ivec3 &localPos)
+    {
+        return (localPos.x * REGION_SIZE + localPos.y) * REGION_SIZE + localPos.z;
     }
     string World::GetRegionFilename(const ivec3 &pos)
     {
         return "r." + std::to_string(pos.x) + "." + std::to_string(pos.y) + "." + std::to_string(pos.z) + ".hjbt";
     }
+    string World::GetRegionDirectory()
+    {
+        // keep the original folder for 32^3 chunks so old saves still load
+        if (Chunk::CHUNK_SIZE == 32)
+            return "region";
+
+        return "region_" + std::to_string(Chunk::CHUNK_SIZE);
+    }
 }
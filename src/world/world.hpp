@@ -2,6 +2,11 @@
 
 #include "world/entity/entity.hpp"
 #include "world/world_generator.hpp"
+#include "world/world_settings.hpp"
+#include "world/block_accessor.hpp"
+#include "world/block_edit_session.hpp"
+#include "world/chunk/chunk_storage_cache.hpp"
+#include "world/chunk/chunk_grid.hpp"
 
 namespace cybrion
 {
@@ -29,6 +34,8 @@ namespace cybrion
 
         Block &getBlock(const ivec3 &pos);
         Block *tryGetBlock(const ivec3 &pos);
+        // brick only has air, false when its chunk is not loaded
+        bool isBrickEmpty(const ivec3 &brickPos);
         BlockModifyResult setBlock(const ivec3 &pos, Block &block);
         BlockModifyResult updateBlock(const ivec3 &pos, Block &block);
         BlockModifyResult placeBlock(const ivec3 &pos, Block &block);
@@ -40,25 +47,146 @@ namespace cybrion
         void loadRegion(const ivec3 &pos);
         void save(const string &path);
         void saveChunk(const ivec3 &pos, const ref<Chunk> &chunk);
+        // saves the chunks waiting in the save queue
+        void flushSaveQueue();
         void syncRegionFiles();
-
-        static void createNewWorld(const string &name);
+        // saved and decorated, the record is read to know
+        bool isChunkSaved(const ivec3 &pos);
+        // reads a saved chunk into chunk without loading it in the world,
+        // false when it was never saved
+        bool readSavedChunk(const ivec3 &pos, Chunk &chunk);
+        // saves the save queue and closes region files of unloaded areas
+        void closeUnusedRegions();
+
+        // rebuilds the load ranges, the next tick loads and unloads to match
+        void setSettings(const WorldSettings &settings);
+        const WorldSettings &getSettings() const;
+
+        u64 getResidentMemory() const;
+        u64 getFrozenMemory() const;
+        u32 getFrozenChunkCount() const;
+        // bytes taken by region files after the last save
+        u64 getSaveSize() const;
+        u32 getSaveQueueSize() const;
+        // ticks the oldest chunk in the save queue has waited
+        u32 getSaveQueueAge() const;
+        // chunks kept loaded because the save queue is backed up
+        u32 getDeferredUnloadCount() const;
+        void updateSaveSize();
+
+        // a random seed unless one is given
+        static void createNewWorld(const string &worldPath, const string &name);
+        static void createNewWorld(const string &worldPath, const string &name, i32 seed);
         static ref<World> loadWorld(const string &path);
 
         static ivec3 ToRegionPos(const ivec3 &pos);
         static ivec3 ToLocalRegionPos(const ivec3 &pos);
+        static u32 ToRegionChunkId(const ivec3 &localPos);
         static string GetRegionFilename(const ivec3 &pos);
+        // chunks of other sizes can't share region files
+        static string GetRegionDirectory();
+
+        // a region file holds REGION_SIZE^3 chunks
+        static constexpr i32 LOG_2_REGION_SIZE = 5;
+        static constexpr i32 REGION_SIZE = 1 << LOG_2_REGION_SIZE;
+        static constexpr i32 REGION_VOLUME = REGION_SIZE * REGION_SIZE * REGION_SIZE;
+
+        // chunks this close to the player are thawed ahead of need
+        static constexpr i32 THAW_DISTANCE = 2;
+
+        // generation of the last neighbors a chunk waits for is made urgent
+        static constexpr u32 PROMOTE_WAITING_NEIGHBORS = 3;
+
+        // microseconds per tick spent on the save queue, grows with its
+        // length up to the max
+        static constexpr u32 SAVE_TIME_BUDGET = 2000;
+        static constexpr u32 MAX_SAVE_TIME_BUDGET = 10000;
+
+        // past the high water mark, chunks that have to be saved stay loaded
+        // until the queue is back at the low water mark
+        static constexpr u32 SAVE_QUEUE_HIGH_WATER = 256;
+        static constexpr u32 SAVE_QUEUE_LOW_WATER = 64;
 
     private:
+        friend class BlockAccessor;
+        friend class WorldPregenerator;
+
+        // finish chunks whose generation or decoration jobs are done
+        void processChunkResults();
+        // saves the save queue and the decorated chunks changed since their
+        // last save, undecorated chunks are left to be generated again
+        void saveChangedChunks();
+        // decorate on a worker once all neighbors are ready
+        void decorateChunk(const ref<Chunk> &chunk);
+        void publishDecoration(const ref<Chunk> &chunk, ChunkDecoration &decoration);
+
+        // unloads the chunk unless the save queue is backed up and the chunk
+        // would add to it, then it is kept and tried again later
+        bool requestUnload(const ivec3 &pos);
+        void drainSaveQueue();
+        void retryDeferredUnloads(const ivec3 &ppos);
+
+        void updateFrozenChunks(const ivec3 &ppos);
+        void updateLoadFrontier(const ivec3 &ppos);
+        void unloadOverBudget(const ivec3 &ppos, u64 loaded);
+
+        void buildLoadOffsets();
+        bool isInLoadRange(const ivec3 &offset) const;
+        bool isInUnloadRange(const ivec3 &offset) const;
+
+        // raw pointer for hot paths, valid until the chunk is unloaded
+        Chunk *findChunk(const ivec3 &pos);
+
         u32 chunkId = 0;
 
+        WorldSettings m_settings;
+
+        u64 m_residentMemory;
+        u64 m_frozenMemory;
+        u32 m_frozenChunkCount;
+        u64 m_saveSize;
+        u64 m_tick;
+
+        // offsets in the load range nearest first, and in the unload range
+        vector<ivec3> m_loadOffsets;
+        vector<ivec3> m_unloadOffsets;
+        bool m_hasLoadCenter;
+        ivec3 m_loadCenter;
+
         WorldGenerator m_generator;
+        ChunkStorageCache m_storageCache;
+        // grid around the player answers most lookups, the map has every
+        // loaded chunk and is only searched outside the grid
+        ChunkGrid m_chunkGrid;
         umap<ivec3, ref<Chunk>> m_chunkMap;
         vector<ref<Entity>> m_entities;
-        queue<ref<Chunk>> m_saveChunkQueue;
+        struct SaveRequest
+        {
+            ref<Chunk> chunk;
+            // tick it was queued on
+            u64 tick;
+        };
+
+        queue<SaveRequest> m_saveChunkQueue;
+        bool m_saveBackpressure;
+        uset<ivec3> m_deferredUnloads;
 
         moodycamel::ConcurrentQueue<ref<Chunk>> m_loadChunkResults;
 
+        struct DecorationResult
+        {
+            ref<Chunk> chunk;
+            ChunkDecoration decoration;
+        };
+
+        moodycamel::ConcurrentQueue<DecorationResult> m_decorationResults;
+        // decoration writes into loaded chunks that are not decorated yet,
+        // applied after their own decoration, saved with the chunk when it
+        // unloads first and read back when it is loaded again
+        umap<ivec3, vector<DecorationWrite>> m_pendingWrites;
+        // writes of unloaded undecorated chunks waiting in the save queue
+        umap<ivec3, vector<DecorationWrite>> m_unloadedWrites;
+
         umap<ivec3, ref<jbt::hjbt_file>> m_regionMap;
 
         string m_name;
@@ -5,7 +5,48 @@
 
 namespace cybrion
 {
-    WorldGenerator::WorldGenerator(i32 seed) : m_biomeNoise0(seed << 0),
+    DecorationBuilder::DecorationBuilder(const ChunkSnapshot &snapshot, const ivec3 &chunkPos) : m_snapshot(snapshot),
+                                                                                                 m_chunkPos(chunkPos)
+    {
+    }
+
+    Block *DecorationBuilder::tryGetBlock(const ivec3 &pos) const
+    {
+        auto it = m_writes.find(pos);
+        if (it != m_writes.end())
+            return it->second;
+
+        if (Chunk::posToChunkPos(pos) != m_chunkPos)
+            return nullptr;
+
+        return &m_snapshot.getBlock(Chunk::posToLocalPos(pos));
+    }
+
+    void DecorationBuilder::setBlock(const ivec3 &pos, Block &block)
+    {
+        m_writes[pos] = &block;
+    }
+
+    ChunkDecoration DecorationBuilder::finish()
+    {
+        ChunkDecoration decoration;
+
+        for (auto &[pos, block] : m_writes)
+        {
+            ivec3 chunkPos = Chunk::posToChunkPos(pos);
+
+            if (chunkPos == m_chunkPos)
+                decoration.own.push_back({pos, block});
+            else
+                decoration.others[chunkPos].push_back({pos, block});
+        }
+
+        m_writes.clear();
+        return decoration;
+    }
+
+    WorldGenerator::WorldGenerator(i32 seed) : m_seed(seed),
+                                               m_biomeNoise0(seed << 0),
                                                m_biomeNoise1(seed << 1),
                                                m_plainNoise(seed << 2),
                                                m_desertNoise(seed << 3)
@@ -36,6 +77,18 @@ namespace cybrion
     void WorldGenerator::generateChunkAt(const ref<Chunk> &chunk)
     {
         ivec3 chunkPos = chunk->getChunkPos() * Chunk::CHUNK_SIZE;
+
+        // everything below y = 0 is solid stone
+        if (chunkPos.y < 0)
+        {
+            chunk->fill(Blocks::STONE);
+            return;
+        }
+
+        // terrain uses a handful of blocks, start with storage wide enough
+        // for all of them instead of growing it while filling
+        chunk->reserveBlockTypes(TERRAIN_BLOCK_TYPES);
+
         for (i32 x = 0; x < Chunk::CHUNK_SIZE; ++x)
         {
             for (i32 z = 0; z < Chunk::CHUNK_SIZE; ++z)
@@ -44,89 +97,73 @@ namespace cybrion
                 f32 wposX = chunkPos.x + x;
                 f32 wposZ = chunkPos.z + z;
 
-                if (chunkPos.y >= 0)
-                {
-                    bool hasMountain = false;
-                    bool hasRiver = false;
+                bool hasMountain = false;
+                bool hasRiver = false;
 
-                    f32 wNoise = m_noise.GetNoise(wposX, wposZ);
-                    f32 mountainNoise = m_noise.GetNoise(wposX / 2, wposZ / 2) * 0.8 + m_noise.GetNoise(wposX * 4, wposZ * 4) * 0.1 + m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.1;
+                f32 wNoise = m_noise.GetNoise(wposX, wposZ);
+                f32 mountainNoise = m_noise.GetNoise(wposX / 2, wposZ / 2) * 0.8 + m_noise.GetNoise(wposX * 4, wposZ * 4) * 0.1 + m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.1;
 
-                    mountainNoise = (mountainNoise + 1) / 2;
+                mountainNoise = (mountainNoise + 1) / 2;
 
-                    if (mountainNoise > 0.65)
-                    {
-                        hasMountain = true;
-                        f32 wNoise1 = m_noise.GetNoise(wposX * 2 + 1024, wposZ * 2 + 1024) * 0.5 + m_noise.GetNoise(wposX * 4 + 1024, wposZ * 4 + 1024) * 0.25 + m_noise.GetNoise(wposX * 8 + 1024, wposZ * 8 + 1024) * 0.25;
-                        wNoise1 = pow((wNoise1 + 1) / 2, 2);
-                        wNoise += (mountainNoise - 0.65f) * 25 * wNoise1;
-                    }
+                if (mountainNoise > 0.65)
+                {
+                    hasMountain = true;
+                    f32 wNoise1 = m_noise.GetNoise(wposX * 2 + 1024, wposZ * 2 + 1024) * 0.5 + m_noise.GetNoise(wposX * 4 + 1024, wposZ * 4 + 1024) * 0.25 + m_noise.GetNoise(wposX * 8 + 1024, wposZ * 8 + 1024) * 0.25;
+                    wNoise1 = pow((wNoise1 + 1) / 2, 2);
+                    wNoise += (mountainNoise - 0.65f) * 25 * wNoise1;
+                }
 
-                    f32 river = getRiverValue(wposX, wposZ);
+                f32 river = getRiverValue(wposX, wposZ);
 
-                    hasRiver = river > 0;
+                hasRiver = river > 0;
 
-                    if (hasRiver && !hasMountain)
-                    {
-                        f32 noise = wNoise * 0.8 + m_plainNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_plainNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
+                if (hasRiver && !hasMountain)
+                {
+                    f32 noise = wNoise * 0.8 + m_plainNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_plainNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
 
-                        i32 wh = (noise + 1) / 2 * 40 + 15;
-                        i32 dh = std::min(Chunk::CHUNK_SIZE, i32(abs(river - 0.25) / 0.05f * (wh - 35) + 23) - chunkPos.y);
-                        i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
-                        i32 y = 0;
+                    i32 wh = (noise + 1) / 2 * 40 + 15;
+                    i32 dh = std::min(Chunk::CHUNK_SIZE, i32(abs(river - 0.25) / 0.05f * (wh - 35) + 23) - chunkPos.y);
+                    i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
+                    i32 y = 0;
 
-                        for (; y < dh; ++y)
-                        {
-                            chunk->setBlock({x, y, z}, Blocks::SAND);
-                        }
+                    for (; y < dh; ++y)
+                    {
+                        chunk->setBlock({x, y, z}, Blocks::SAND);
+                    }
 
-                        for (; y < lh; ++y)
-                        {
-                            chunk->setBlock({x, y, z}, Blocks::WATER);
-                        }
-                        continue;
+                    for (; y < lh; ++y)
+                    {
+                        chunk->setBlock({x, y, z}, Blocks::WATER);
                     }
+                    continue;
+                }
 
-                    if (biome == BiomeType::PLAIN)
+                if (biome == BiomeType::PLAIN)
+                {
+                    // PLAIN
+                    // |
+                    // |- 75
+                    // |
+                    // |---------------------------  -> grass  : 1
+                    // |    .             .        | -> dirt   : 5-10
+                    // |         .    .         .  | -> stone  : 20-30
+                    // |---------------------------|
+                    //
+                    constexpr i32 MAX_PLAIN_HEIGHT = 45;
+
+                    f32 noise = wNoise * 0.8 + m_plainNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_plainNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
+
+                    i32 wh = (noise + 1) / 2 * MAX_PLAIN_HEIGHT + 15;
+                    i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
+
+                    for (i32 y = 0; y < lh; ++y)
                     {
-                        // PLAIN
-                        // |
-                        // |- 75
-                        // |
-                        // |---------------------------  -> grass  : 1
-                        // |    .             .        | -> dirt   : 5-10
-                        // |         .    .         .  | -> stone  : 20-30
-                        // |---------------------------|
-                        //
-                        constexpr i32 MAX_PLAIN_HEIGHT = 45;
-
-                        f32 noise = wNoise * 0.8 + m_plainNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_plainNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
-
-                        i32 wh = (noise + 1) / 2 * MAX_PLAIN_HEIGHT + 15;
-                        i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
-
-                        for (i32 y = 0; y < lh; ++y)
+                        i32 wy = y + chunkPos.y;
+                        if (hasMountain)
                         {
-                            i32 wy = y + chunkPos.y;
-                            if (hasMountain)
-                            {
-                                f32 shitNoise = m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.40 + m_noise.GetNoise(wposX * 16, wposZ * 16) * 0.20 + m_noise.GetNoise(wposX * 32, wposZ * 32) * 0.40;
-
-                                if (wy < 75 - shitNoise * 10)
-                                {
-                                    if (wy == wh - 1)
-                                        chunk->setBlock({x, y, z}, Blocks::GRASS_BLOCK);
-                                    else if (wy > wh * 3 / 4)
-                                        chunk->setBlock({x, y, z}, Blocks::DIRT);
-                                    else
-                                        chunk->setBlock({x, y, z}, Blocks::STONE);
-                                }
-                                else
-                                {
-                                    chunk->setBlock({x, y, z}, (i32(shitNoise * 20) % 5 != 0) ? Blocks::STONE : Blocks::COBBLESTONE);
-                                }
-                            }
-                            else
+                            f32 shitNoise = m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.40 + m_noise.GetNoise(wposX * 16, wposZ * 16) * 0.20 + m_noise.GetNoise(wposX * 32, wposZ * 32) * 0.40;
+
+                            if (wy < 75 - shitNoise * 10)
                             {
                                 if (wy == wh - 1)
                                     chunk->setBlock({x, y, z}, Blocks::GRASS_BLOCK);
@@ -135,82 +172,87 @@ namespace cybrion
                                 else
                                     chunk->setBlock({x, y, z}, Blocks::STONE);
                             }
+                            else
+                            {
+                                chunk->setBlock({x, y, z}, (i32(shitNoise * 20) % 5 != 0) ? Blocks::STONE : Blocks::COBBLESTONE);
+                            }
+                        }
+                        else
+                        {
+                            if (wy == wh - 1)
+                                chunk->setBlock({x, y, z}, Blocks::GRASS_BLOCK);
+                            else if (wy > wh * 3 / 4)
+                                chunk->setBlock({x, y, z}, Blocks::DIRT);
+                            else
+                                chunk->setBlock({x, y, z}, Blocks::STONE);
                         }
                     }
-                    else if (biome == BiomeType::DESERT)
-                    {
-                        constexpr i32 MAX_DESERT_HEIGHT = 45;
+                }
+                else if (biome == BiomeType::DESERT)
+                {
+                    constexpr i32 MAX_DESERT_HEIGHT = 45;
 
-                        f32 noise = wNoise * 0.8 + m_desertNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_desertNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
+                    f32 noise = wNoise * 0.8 + m_desertNoise.GetNoise(wposX * 8, wposZ * 8) * 0.10f + m_desertNoise.GetNoise(wposX * 16, wposZ * 16) * 0.10f;
 
-                        f32 bigRockNoise = m_noise.GetNoise(wposX * 2 + 1024, wposZ * 2 + 1024);
-                        bigRockNoise = (bigRockNoise + 1) / 2;
+                    f32 bigRockNoise = m_noise.GetNoise(wposX * 2 + 1024, wposZ * 2 + 1024);
+                    bigRockNoise = (bigRockNoise + 1) / 2;
 
-                        bool isBigRock = false;
+                    bool isBigRock = false;
 
-                        if (bigRockNoise > 0.92)
-                        {
-                            isBigRock = true;
-                            noise += std::min(0.93f - 0.92f, bigRockNoise - 0.92f) * 35 + std::max(0.0f, bigRockNoise - 0.93f) * 5 * (m_noise.GetNoise(wposX * 32 + 512, wposZ * 32 + 512) + 1);
-                        }
+                    if (bigRockNoise > 0.92)
+                    {
+                        isBigRock = true;
+                        noise += std::min(0.93f - 0.92f, bigRockNoise - 0.92f) * 35 + std::max(0.0f, bigRockNoise - 0.93f) * 5 * (m_noise.GetNoise(wposX * 32 + 512, wposZ * 32 + 512) + 1);
+                    }
 
-                        i32 wh = (noise + 1) / 2 * MAX_DESERT_HEIGHT + 15;
-                        i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
+                    i32 wh = (noise + 1) / 2 * MAX_DESERT_HEIGHT + 15;
+                    i32 lh = std::min(Chunk::CHUNK_SIZE, wh - chunkPos.y);
 
-                        for (i32 y = 0; y < lh; ++y)
-                        {
-                            i32 wy = y + chunkPos.y;
+                    for (i32 y = 0; y < lh; ++y)
+                    {
+                        i32 wy = y + chunkPos.y;
 
-                            if (hasMountain)
-                            {
-                                f32 shitNoise = m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.20 + m_noise.GetNoise(wposX * 16, wposZ * 16) * 0.40 + m_noise.GetNoise(wposX * 32, wposZ * 32) * 0.40;
+                        if (hasMountain)
+                        {
+                            f32 shitNoise = m_noise.GetNoise(wposX * 8, wposZ * 8) * 0.20 + m_noise.GetNoise(wposX * 16, wposZ * 16) * 0.40 + m_noise.GetNoise(wposX * 32, wposZ * 32) * 0.40;
 
-                                if (wy < 75 - shitNoise * 10)
-                                    chunk->setBlock({x, y, z}, Blocks::SAND);
-                                else
-                                    chunk->setBlock({x, y, z}, (i32(shitNoise * 20) % 5 != 0) ? Blocks::STONE : Blocks::COBBLESTONE);
-                            }
-                            else if (isBigRock)
-                            {
-                                if (wy > wh - 3)
-                                    chunk->setBlock({x, y, z}, Blocks::SAND);
-                                else
-                                    chunk->setBlock({x, y, z}, Blocks::STONE);
-                            }
+                            if (wy < 75 - shitNoise * 10)
+                                chunk->setBlock({x, y, z}, Blocks::SAND);
                             else
-                            {
-                                if (wy > wh * 3 / 4)
-                                    chunk->setBlock({x, y, z}, Blocks::SAND);
-                                else
-                                    chunk->setBlock({x, y, z}, Blocks::STONE);
-                            }
+                                chunk->setBlock({x, y, z}, (i32(shitNoise * 20) % 5 != 0) ? Blocks::STONE : Blocks::COBBLESTONE);
+                        }
+                        else if (isBigRock)
+                        {
+                            if (wy > wh - 3)
+                                chunk->setBlock({x, y, z}, Blocks::SAND);
+                            else
+                                chunk->setBlock({x, y, z}, Blocks::STONE);
+                        }
+                        else
+                        {
+                            if (wy > wh * 3 / 4)
+                                chunk->setBlock({x, y, z}, Blocks::SAND);
+                            else
+                                chunk->setBlock({x, y, z}, Blocks::STONE);
                         }
-                    }
-                }
-                else
-                {
-                    for (i32 y = 0; y < 32; ++y)
-                    {
-                        chunk->setBlock({x, y, z}, Blocks::STONE);
                     }
                 }
             }
         }
+
+        // shrink the reserved storage to what the terrain actually used
+        chunk->compact();
     }
 
-    void WorldGenerator::generateStructure(const ref<Chunk> &chunk)
+    ChunkDecoration WorldGenerator::decorateChunk(const ChunkSnapshot &snapshot, const Chunk::Heightmap &heights, const ivec3 &chunk) const
     {
-        if (!chunk->isNewChunk())
-        {
-            chunk->m_hasStructure = true;
-            return;
-        }
-
-        auto &world = Game::Get().getWorld();
+        DecorationBuilder builder(snapshot, chunk);
+        RandomStream rng(m_seed, chunk, RandomPurpose::DECORATION);
 
-        ivec3 chunkPos = chunk->getChunkPos() * Chunk::CHUNK_SIZE;
+        ivec3 chunkPos = chunk * Chunk::CHUNK_SIZE;
 
-        if (chunkPos.y > 20 && chunkPos.y < 50)
+        // chunks outside the band have no surface to decorate
+        if (chunkPos.y + Chunk::CHUNK_SIZE > MIN_DECORATION_HEIGHT && chunkPos.y < MAX_DECORATION_HEIGHT)
             for (i32 x = 0; x < Chunk::CHUNK_SIZE; ++x)
                 for (i32 z = 0; z < Chunk::CHUNK_SIZE; ++z)
                 {
@@ -236,69 +278,80 @@ namespace cybrion
                     cactusNoise = (cactusNoise + 1) / 2;
                     cactusNoise = pow(cactusNoise, 3);
 
-                    for (i32 y = 0; y < Chunk::CHUNK_SIZE; ++y)
+                    // only the topmost opaque block of the column can be decorated
+                    i32 y = i32(heights[x * Chunk::CHUNK_SIZE + z]) - 1;
+                    if (y < 0)
+                        continue;
+
+                    ivec3 wpos = chunkPos + ivec3(x, y, z);
+
+                    // the surface itself is tested, so the chunk size doesn't matter
+                    if (wpos.y < MIN_DECORATION_HEIGHT || wpos.y >= MAX_DECORATION_HEIGHT)
+                        continue;
+
+                    Block *top = builder.tryGetBlock(wpos);
+                    // above the chunk counts as not air, the chunk there may
+                    // or may not be decorated yet
+                    Block *above = builder.tryGetBlock(wpos + ivec3(0, 1, 0));
+
+                    if (*top == Blocks::GRASS_BLOCK)
                     {
-                        ivec3 wpos = chunkPos + ivec3(x, y, z);
-                        if (chunk->getBlock({x, y, z}) == Blocks::GRASS_BLOCK)
+                        if (forestNoise > 0.5f && treeNoise > 0.9f)
                         {
-                            if (forestNoise > 0.5f && treeNoise > 0.9f)
-                            {
-                                growTreeAt(chunkPos + ivec3(x, y + 1, z));
-                                break;
-                            }
-                            else if (forestNoise > 0.3f && grassNoise > 0.75)
-                            {
-                                auto &grass = Blocks::GRASS.set<"type">((PlantType)(rand() % 2));
-                                world.setBlock(chunkPos + ivec3(x, y + 1, z), grass);
-                                break;
-                            }
-                            else if (flowerNoise > 0.9f)
-                            {
-                                auto &flower = Blocks::GRASS.set<"type">((PlantType)((rand() % 11) + 2));
-                                world.setBlock(chunkPos + ivec3(x, y + 1, z), flower);
-                                break;
-                            }
+                            // a tree looks the same whatever else the chunk grew
+                            ivec3 treePos = chunkPos + ivec3(x, y + 1, z);
+                            RandomStream treeRng(m_seed, treePos, RandomPurpose::TREE);
+                            growTreeAt(builder, treeRng, treePos);
                         }
-                        else if (chunk->getBlock({x, y, z}) == Blocks::SAND && Game::Get().getWorld().getBlock(wpos + ivec3(0, 1, 0)) == Blocks::AIR)
+                        else if (forestNoise > 0.3f && grassNoise > 0.75)
                         {
-                            if (cactusNoise > 0.95f)
-                            {
-                                i32 height = (rand() % 2) + 3;
-                                for (i32 i = 1; i <= height; ++i)
-                                    world.setBlock(chunkPos + ivec3(x, y + i, z), Blocks::CACTUS);
-                            }
+                            auto &grass = Blocks::GRASS.set<"type">((PlantType)(rng() % 2));
+                            builder.setBlock(chunkPos + ivec3(x, y + 1, z), grass);
+                        }
+                        else if (flowerNoise > 0.9f)
+                        {
+                            auto &flower = Blocks::GRASS.set<"type">((PlantType)((rng() % 11) + 2));
+                            builder.setBlock(chunkPos + ivec3(x, y + 1, z), flower);
+                        }
+                    }
+                    else if (*top == Blocks::SAND && above && *above == Blocks::AIR)
+                    {
+                        if (cactusNoise > 0.95f)
+                        {
+                            i32 height = (rng() % 2) + 3;
+                            for (i32 i = 1; i <= height; ++i)
+                                builder.setBlock(chunkPos + ivec3(x, y + i, z), Blocks::CACTUS);
                         }
                     }
                 }
 
-        chunk->m_hasStructure = true;
+        return builder.finish();
     }
 
-    void WorldGenerator::growTreeAt(const ivec3 &pos)
+    void WorldGenerator::growTreeAt(DecorationBuilder &builder, RandomStream &rng, const ivec3 &pos) const
     {
-        auto &world = Game::Get().getWorld();
-        auto type = WoodType(rand() % 7);
+        auto type = WoodType(rng() % 7);
         auto &wood = Blocks::OAK_LOG.set<"axis">(LogAxis::Y).set<"type">(type);
         auto &leaf = Blocks::OAK_LEAF.set<"type">(type);
         ivec3 p = pos;
 
-        i32 h = (rand() % 3) + 2;
+        i32 h = (rng() % 3) + 2;
 
         for (i32 i = 0; i < h; ++i)
         {
-            world.setBlock(p, wood);
+            builder.setBlock(p, wood);
             p.y += 1;
         }
 
         for (i32 i = -1; i <= 1; ++i)
             for (i32 j = -1; j <= 1; ++j)
-                if (!(i == 0 && j == 0) && (rand() % 3) == 0)
-                    world.setBlock(p + ivec3(i, -1, j), leaf);
+                if (!(i == 0 && j == 0) && (rng() % 3) == 0)
+                    builder.setBlock(p + ivec3(i, -1, j), leaf);
 
-        world.setBlock(p, wood);
+        builder.setBlock(p, wood);
 
-        i32 dx = (rand() % 3) - 1;
-        i32 dz = (rand() % 3) - 1;
+        i32 dx = (rng() % 3) - 1;
+        i32 dz = (rng() % 3) - 1;
 
         if (dx == 0 && dz == 0)
             dx = 1;
@@ -308,7 +361,7 @@ namespace cybrion
 
         for (i32 i = 0; i < h; ++i)
         {
-            world.setBlock(p, wood);
+            builder.setBlock(p, wood);
             p.y += 1;
         }
 
@@ -323,7 +376,7 @@ namespace cybrion
             for (i32 j = -lh; j <= lh; ++j)
             {
                 if ((abs(i) - lh) + (abs(j) - lh) != 0)
-                    world.setBlock(p + ivec3(i, 0, j), leaf);
+                    builder.setBlock(p + ivec3(i, 0, j), leaf);
             }
         }
 
@@ -334,11 +387,28 @@ namespace cybrion
             for (i32 j = -lh; j <= lh; ++j)
             {
                 if ((abs(i) - lh) + (abs(j) - lh) != 0)
-                    world.setBlock(p + ivec3(i, 0, j), leaf);
+                    builder.setBlock(p + ivec3(i, 0, j), leaf);
             }
         }
     }
 
+    bool WorldGenerator::CanDecorationReplace(Block &current, Block &block)
+    {
+        if (current == Blocks::AIR || current.getType() == BlockType::WATER)
+            return true;
+
+        switch (current.getType())
+        {
+        case BlockType::LOG:
+        case BlockType::LEAF:
+        case BlockType::PLANT:
+        case BlockType::CACTUS:
+            return block.getId() > current.getId();
+        default:
+            return false;
+        }
+    }
+
     BiomeType WorldGenerator::getBiome(i32 x, i32 z) const
     {
         f32 noise0 = m_biomeNoise0.GetNoise(f32(x), f32(z)) * 0.5;
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "world/chunk/chunk.hpp"
+#include "world/chunk/chunk_snapshot.hpp"
+#include "core/random.hpp"
 
 namespace cybrion
 {
@@ -12,20 +13,74 @@ namespace cybrion
         HILL
     };
 
+    // block written by a decoration, pos is a world position
+    struct DecorationWrite
+    {
+        ivec3 pos;
+        Block *block;
+    };
+
+    struct ChunkDecoration
+    {
+        // writes into the decorated chunk
+        vector<DecorationWrite> own;
+        // writes that fall into other chunks, by their chunk position
+        umap<ivec3, vector<DecorationWrite>> others;
+    };
+
+    // collects the writes of one chunk decoration, reads see earlier writes
+    // and are limited to the decorated chunk
+    class DecorationBuilder
+    {
+    public:
+        DecorationBuilder(const ChunkSnapshot &snapshot, const ivec3 &chunkPos);
+
+        // null outside the decorated chunk
+        Block *tryGetBlock(const ivec3 &pos) const;
+        void setBlock(const ivec3 &pos, Block &block);
+
+        ChunkDecoration finish();
+
+    private:
+        const ChunkSnapshot &m_snapshot;
+        ivec3 m_chunkPos;
+        // a later write to the same position replaces the earlier one
+        umap<ivec3, Block *> m_writes;
+    };
+
     class WorldGenerator
     {
     public:
         WorldGenerator(i32 seed);
 
         void generateChunkAt(const ref<Chunk> &chunk);
-        void generateStructure(const ref<Chunk> &chunk);
 
-        void growTreeAt(const ivec3 &pos);
+        // runs on a worker, only the decorated chunk is read and the random
+        // streams are keyed by the seed and position, so the result doesn't
+        // depend on which chunks were decorated first or on which thread
+        ChunkDecoration decorateChunk(const ChunkSnapshot &snapshot, const Chunk::Heightmap &heights, const ivec3 &chunkPos) const;
+
+        // rng is the tree stream keyed by pos
+        void growTreeAt(DecorationBuilder &builder, RandomStream &rng, const ivec3 &pos) const;
+
+        // whether a write from another chunk's decoration may replace the
+        // current block, it never replaces terrain and between decorations
+        // the higher block id wins, so any order ends with the same block
+        static bool CanDecorationReplace(Block &current, Block &block);
 
         BiomeType getBiome(i32 x, i32 z) const;
         f32 getRiverValue(f32 x, f32 z) const;
 
+        // air, water, sand, grass block, dirt, stone and cobblestone
+        static constexpr u32 TERRAIN_BLOCK_TYPES = 7;
+
+        // surface blocks with MIN <= y < MAX are decorated, the heights of
+        // chunk y = 1 with 32 block chunks, the only chunk decorated before
+        static constexpr i32 MIN_DECORATION_HEIGHT = 32;
+        static constexpr i32 MAX_DECORATION_HEIGHT = 64;
+
     private:
+        i32 m_seed;
         FastNoiseLite m_noise;
         FastNoiseLite m_plainNoise;
         FastNoiseLite m_desertNoise;
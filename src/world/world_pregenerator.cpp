@@ -0,0 +1,269 @@
+#include "world/world_pregenerator.hpp"
+#include "game.hpp"
+
+using namespace std::chrono;
+
+namespace cybrion
+{
+    WorldPregenerator::WorldPregenerator(World &world, const ivec3 &center, i32 radius) : m_world(world),
+                                                                                           m_center(center),
+                                                                                           m_radius(radius),
+                                                                                           m_doneTiles(0),
+                                                                                           m_skippedTiles(0),
+                                                                                           m_doneChunks(0),
+                                                                                           m_startSaveSize(0)
+    {
+        i32 h = world.getSettings().verticalLoadDistance;
+        m_minY = center.y - h;
+        m_maxY = center.y + h;
+    }
+
+    bool WorldPregenerator::run(const std::atomic<bool> &stopRequested)
+    {
+        buildTiles();
+
+        // tiles finished by an earlier run
+        std::erase_if(m_tiles, [this](const Tile &tile)
+                      { return isTileSaved(tile); });
+        m_world.closeUnusedRegions();
+
+        CYBRION_GAME_INFO("Pregenerating radius {} around chunk ({}, {}), {} tiles left, {} already saved",
+                          m_radius, m_center.x, m_center.z, m_tiles.size(), m_skippedTiles);
+
+        m_world.updateSaveSize();
+        m_startSaveSize = m_world.getSaveSize();
+        m_startTime = high_resolution_clock::now();
+        m_reportStopwatch.reset();
+
+        bool completed = true;
+
+        for (u32 i = 0; i < m_tiles.size(); ++i)
+        {
+            // the current tile is always finished so its checkpoint is whole
+            if (stopRequested)
+            {
+                completed = false;
+                break;
+            }
+
+            loadTiles(i);
+            waitForTile(m_tiles[i]);
+            checkpoint();
+
+            m_doneTiles += 1;
+            m_doneChunks += m_tiles[i].columns.size() * (m_maxY - m_minY + 1);
+        }
+
+        unloadAll();
+        report(true);
+
+        return completed;
+    }
+
+    u64 WorldPregenerator::hashSavedChunks()
+    {
+        buildTiles();
+
+        u64 hash = 14695981039346656037ull;
+
+        auto mix = [&](u32 v)
+        {
+            hash ^= v;
+            hash *= 1099511628211ull;
+        };
+
+        for (auto &tile : m_tiles)
+            for (auto &column : tile.columns)
+                for (i32 y = m_minY; y <= m_maxY; ++y)
+                {
+                    ivec3 pos = {column.x, y, column.y};
+
+                    // not make_shared, it would bypass the chunk pool
+                    ref<Chunk> chunk(new Chunk(pos));
+
+                    // palettes depend on the write order, the blocks don't
+                    if (!m_world.readSavedChunk(pos, *chunk))
+                    {
+                        mix(u32(-1));
+                        continue;
+                    }
+
+                    chunk->eachBlocks([&](Block &block, const ivec3 &)
+                                      { mix(block.getId()); });
+                }
+
+        m_world.closeUnusedRegions();
+
+        return hash;
+    }
+
+    void WorldPregenerator::buildTiles()
+    {
+        m_tiles.clear();
+
+        i32 r = m_radius / TILE_SIZE + 1;
+
+        for (i32 tx = -r; tx <= r; ++tx)
+            for (i32 tz = -r; tz <= r; ++tz)
+            {
+                Tile tile{{tx, tz}, {}};
+
+                for (i32 x = 0; x < TILE_SIZE; ++x)
+                    for (i32 z = 0; z < TILE_SIZE; ++z)
+                    {
+                        ivec2 offset = ivec2(tx, tz) * TILE_SIZE - TILE_SIZE / 2 + ivec2(x, z);
+
+                        if (offset.x * offset.x + offset.y * offset.y <= m_radius * m_radius)
+                            tile.columns.push_back(ivec2(m_center.x, m_center.z) + offset);
+                    }
+
+                if (!tile.columns.empty())
+                    m_tiles.push_back(std::move(tile));
+            }
+
+        // ring by ring around the center, walking each ring keeps consecutive
+        // tiles next to each other so their borders are generated once
+        std::stable_sort(m_tiles.begin(), m_tiles.end(), [](const Tile &a, const Tile &b)
+                         {
+            i32 ringA = std::max(std::abs(a.pos.x), std::abs(a.pos.y));
+            i32 ringB = std::max(std::abs(b.pos.x), std::abs(b.pos.y));
+
+            if (ringA != ringB)
+                return ringA < ringB;
+
+            return std::atan2(f32(a.pos.y), f32(a.pos.x)) < std::atan2(f32(b.pos.y), f32(b.pos.x)); });
+    }
+
+    bool WorldPregenerator::isTileSaved(const Tile &tile)
+    {
+        for (auto &column : tile.columns)
+            for (i32 y = m_minY; y <= m_maxY; ++y)
+                if (!m_world.isChunkSaved({column.x, y, column.y}))
+                    return false;
+
+        m_skippedTiles += 1;
+        return true;
+    }
+
+    uset<ivec3> WorldPregenerator::getTileChunks(const Tile &tile, i32 border) const
+    {
+        uset<ivec3> chunks;
+
+        for (auto &column : tile.columns)
+            for (i32 dx = -border; dx <= border; ++dx)
+                for (i32 dz = -border; dz <= border; ++dz)
+                    for (i32 y = m_minY - border; y <= m_maxY + border; ++y)
+                        chunks.insert({column.x + dx, y, column.y + dz});
+
+        return chunks;
+    }
+
+    void WorldPregenerator::loadTiles(u32 first)
+    {
+        const Tile &current = m_tiles[first];
+        ivec3 focus = {current.columns.front().x, m_center.y, current.columns.front().y};
+
+        GetChunkJobScheduler().setFocus(focus, vec3(0));
+
+        m_world.m_chunkGrid.recenter(focus, [this](const ivec3 &pos)
+                                     {
+            auto it = m_world.m_chunkMap.find(pos);
+            return it == m_world.m_chunkMap.end() ? nullptr : it->second; });
+
+        uset<ivec3> wanted;
+        u32 last = std::min(u32(m_tiles.size()), first + 1 + LOOKAHEAD_TILES);
+
+        for (u32 i = first; i < last; ++i)
+        {
+            auto chunks = getTileChunks(m_tiles[i], GENERATE_BORDER);
+            wanted.insert(chunks.begin(), chunks.end());
+
+            // the scheduler orders the jobs, load order only matters for ties
+            for (auto &pos : chunks)
+                m_world.loadChunk(pos);
+        }
+
+        // decorated chunks that are left go to the save queue
+        vector<ivec3> leaving;
+        for (auto &[pos, chunk] : m_world.m_chunkMap)
+            if (!wanted.contains(pos))
+                leaving.push_back(pos);
+
+        // border chunks decorated with a later tile keep their writes on disk
+        for (auto &pos : leaving)
+            m_world.unloadChunk(pos);
+
+        if (!leaving.empty())
+            m_world.m_storageCache.purge();
+    }
+
+    void WorldPregenerator::waitForTile(const Tile &tile)
+    {
+        auto chunks = getTileChunks(tile, DECORATE_BORDER);
+
+        while (true)
+        {
+            m_world.processChunkResults();
+
+            // drop the chunks that are done, the rest is checked next round
+            std::erase_if(chunks, [this](const ivec3 &pos)
+                          {
+                Chunk *chunk = m_world.findChunk(pos);
+                return chunk && chunk->hasStructure(); });
+
+            if (chunks.empty())
+                return;
+
+            if (m_reportStopwatch.getDeltaTime() >= REPORT_INTERVAL)
+                report(false);
+
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+
+    void WorldPregenerator::checkpoint()
+    {
+        m_world.saveChangedChunks();
+        // regions of finished tiles would stay open for the whole run
+        m_world.closeUnusedRegions();
+    }
+
+    void WorldPregenerator::unloadAll()
+    {
+        vector<ivec3> positions;
+        for (auto &[pos, chunk] : m_world.m_chunkMap)
+            positions.push_back(pos);
+
+        for (auto &pos : positions)
+            m_world.unloadChunk(pos);
+
+        m_world.closeUnusedRegions();
+        m_world.m_storageCache.purge();
+    }
+
+    void WorldPregenerator::report(bool final)
+    {
+        m_reportStopwatch.reset();
+        m_world.updateSaveSize();
+
+        f32 seconds = duration_cast<milliseconds>(high_resolution_clock::now() - m_startTime).count() / 1000.0f;
+        f32 rate = seconds > 0 ? m_doneChunks / seconds : 0;
+        f32 written = (m_world.getSaveSize() - std::min(m_world.getSaveSize(), m_startSaveSize)) / 1048576.0f;
+
+        if (final)
+        {
+            CYBRION_GAME_INFO("Pregenerated {} chunks in {:.1f} s, {:.1f} chunks/s, {:.2f} MB written ({:.2f} MB/s), {}/{} tiles",
+                              m_doneChunks, seconds, rate, written, seconds > 0 ? written / seconds : 0, m_doneTiles, m_tiles.size());
+            return;
+        }
+
+        u32 chunksPerTile = TILE_SIZE * TILE_SIZE * (m_maxY - m_minY + 1);
+        u32 remaining = (m_tiles.size() - m_doneTiles) * chunksPerTile;
+
+        CYBRION_GAME_INFO("Tile {}/{}, {} chunks, {:.1f} chunks/s, {:.2f} MB written, about {:.0f} s left, jobs {}/{}",
+                          m_doneTiles, m_tiles.size(), m_doneChunks, rate, written,
+                          rate > 0 ? remaining / rate : 0,
+                          GetChunkJobScheduler().getQueueDepth(ChunkJobStage::GENERATE),
+                          GetChunkJobScheduler().getQueueDepth(ChunkJobStage::DECORATE));
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "world/world.hpp"
+#include "core/stopwatch.hpp"
+
+namespace cybrion
+{
+    // generates, decorates and saves every chunk of a disc of columns around
+    // a center before anyone plays there, tile by tile nearest first so the
+    // pool always has the next tiles to work on. Tiles whose chunks are all
+    // saved are skipped, so an interrupted run continues where it stopped
+    class WorldPregenerator
+    {
+    public:
+        // radius in chunks, vertically the load distance of the settings
+        WorldPregenerator(World &world, const ivec3 &center, i32 radius);
+
+        // returns false when stopped before the last tile
+        bool run(const std::atomic<bool> &stopRequested);
+
+        // fnv-1a over the block states of the saved chunks of the disc in a
+        // fixed order, the same for any pool size if generation is deterministic
+        u64 hashSavedChunks();
+
+        // tiles are TILE_SIZE x TILE_SIZE columns
+        static constexpr i32 TILE_SIZE = 8;
+        // tiles generated while the current one is decorated
+        static constexpr u32 LOOKAHEAD_TILES = 2;
+        // a chunk is finished once its neighbors are decorated, which needs
+        // their neighbors generated
+        static constexpr i32 DECORATE_BORDER = 1;
+        static constexpr i32 GENERATE_BORDER = 2;
+
+        // microseconds between progress reports
+        static constexpr u32 REPORT_INTERVAL = 5000000;
+
+    private:
+        struct Tile
+        {
+            ivec2 pos;
+            // columns of the tile inside the disc
+            vector<ivec2> columns;
+        };
+
+        void buildTiles();
+        bool isTileSaved(const Tile &tile);
+        // chunks of the columns grown by border in every direction
+        uset<ivec3> getTileChunks(const Tile &tile, i32 border) const;
+
+        void loadTiles(u32 first);
+        void waitForTile(const Tile &tile);
+        // saves every chunk that changed, region files are synced after
+        void checkpoint();
+        void unloadAll();
+
+        void report(bool final);
+
+        World &m_world;
+        ivec3 m_center;
+        i32 m_radius;
+        i32 m_minY;
+        i32 m_maxY;
+
+        vector<Tile> m_tiles;
+
+        u32 m_doneTiles;
+        u32 m_skippedTiles;
+        u32 m_doneChunks;
+        u64 m_startSaveSize;
+
+        time_point m_startTime;
+        Stopwatch m_reportStopwatch;
+    };
+}
@@ -0,0 +1,65 @@
+#include "world/world_settings.hpp"
+
+namespace cybrion
+{
+    void WorldSettings::validate()
+    {
+        loadDistance = std::clamp(loadDistance, 1, MAX_DISTANCE);
+        unloadDistance = std::clamp(unloadDistance, loadDistance, MAX_DISTANCE);
+        verticalLoadDistance = std::clamp(verticalLoadDistance, 1, MAX_VERTICAL_DISTANCE);
+        verticalUnloadDistance = std::clamp(verticalUnloadDistance, verticalLoadDistance, MAX_VERTICAL_DISTANCE);
+        residentMemoryBudget = std::max(residentMemoryBudget, 16u);
+    }
+
+    void WorldSettings::fromJBT(const jbt::tag &tag)
+    {
+        // keys missing from older files keep their defaults
+        if (tag.has("load_distance"))
+            loadDistance = tag.get_int("load_distance");
+        if (tag.has("unload_distance"))
+            unloadDistance = tag.get_int("unload_distance");
+        if (tag.has("vertical_load_distance"))
+            verticalLoadDistance = tag.get_int("vertical_load_distance");
+        if (tag.has("vertical_unload_distance"))
+            verticalUnloadDistance = tag.get_int("vertical_unload_distance");
+        if (tag.has("resident_memory_budget"))
+            residentMemoryBudget = tag.get_uint("resident_memory_budget");
+        if (tag.has("loaded_memory_budget"))
+            loadedMemoryBudget = tag.get_uint("loaded_memory_budget");
+
+        validate();
+    }
+
+    jbt::tag WorldSettings::toJBT() const
+    {
+        jbt::tag tag(jbt::tag_type::OBJECT);
+
+        tag.set_int("load_distance", loadDistance);
+        tag.set_int("unload_distance", unloadDistance);
+        tag.set_int("vertical_load_distance", verticalLoadDistance);
+        tag.set_int("vertical_unload_distance", verticalUnloadDistance);
+        tag.set_uint("resident_memory_budget", residentMemoryBudget);
+        tag.set_uint("loaded_memory_budget", loadedMemoryBudget);
+
+        return tag;
+    }
+
+    WorldSettings WorldSettings::Load(const string &path)
+    {
+        WorldSettings settings;
+
+        if (std::filesystem::exists(path))
+        {
+            jbt::tag tag;
+            jbt::open_tag(tag, path);
+            settings.fromJBT(tag);
+        }
+
+        return settings;
+    }
+
+    void WorldSettings::Save(const WorldSettings &settings, const string &path)
+    {
+        jbt::save_tag(settings.toJBT(), path);
+    }
+}
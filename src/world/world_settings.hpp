@@ -0,0 +1,38 @@
+#pragma once
+
+namespace cybrion
+{
+    // distances are in chunks, horizontal ones are disc radii around the
+    // player column and vertical ones are up and down from the player chunk
+    struct WorldSettings
+    {
+        // chunks are loaded inside the load distance and kept until they
+        // leave the unload distance, so walking along a border does not
+        // reload the same chunks over and over
+        i32 loadDistance = 8;
+        i32 unloadDistance = 10;
+        i32 verticalLoadDistance = 4;
+        i32 verticalUnloadDistance = 5;
+
+        // MB, least recently used chunks above it are frozen
+        u32 residentMemoryBudget = 256;
+        // MB, farthest chunks outside the load distance are unloaded above
+        // it, 0 disables it
+        u32 loadedMemoryBudget = 0;
+
+        // clamp values to usable ranges, unload distances never end up
+        // inside the load distances
+        void validate();
+
+        void fromJBT(const jbt::tag &tag);
+        jbt::tag toJBT() const;
+
+        // defaults when the file does not exist yet
+        static WorldSettings Load(const string &path);
+        static void Save(const WorldSettings &settings, const string &path);
+
+        static constexpr i32 MAX_DISTANCE = 32;
+        // the chunk grid is 16 chunks tall
+        static constexpr i32 MAX_VERTICAL_DISTANCE = 7;
+    };
+}
@@ -55,6 +55,7 @@ namespace jbt {
 		void set_tag(const uint32_t& index, tag&& value);
 		void add_tag(tag&& value);
 
+		bool has(const std::string& name) const;
 		uint32_t size() const;
 		void reserve(const uint32_t& size);
 		void resize(const uint32_t& size);
@@ -165,6 +165,12 @@ namespace jbt
 		data.v_byte_array = new byte_array_t(value);
 	}
 
+	bool tag::has(const std::string &name) const
+	{
+		TYPE_CHECK((*this), OBJECT);
+		return data.v_object->find(name) != data.v_object->end();
+	}
+
 	tag &tag::get_tag(const std::string &name) const
 	{
 		TYPE_CHECK((*this), OBJECT);